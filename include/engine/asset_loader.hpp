@@ -0,0 +1,69 @@
+#ifndef ASSET_LOADER_HPP
+#define ASSET_LOADER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+
+#include "engine/thread_pool.hpp"
+
+#include "utils/printer.hpp"
+#include "utils/scene_pack.hpp"
+
+/**
+ * Streams assets in without blocking the GL thread.
+ *
+ * File reading, .3d parsing and image decoding run as jobs on a worker pool. When a job is done it queues an
+ * upload, which only runs on the GL thread from process_uploads(). Until then, whatever depends on the asset
+ * isn't resident and is simply skipped when drawing.
+ *
+ * When a scene pack is mounted, assets are read from it instead of from disk, falling back to disk for anything the
+ * pack doesn't have.
+ */
+namespace asset_loader
+{
+    /**
+     * Queues a job on the worker pool. Jobs must not touch GL.
+     */
+    void submit(std::function<void()> job);
+
+    /**
+     * Queues GL work produced by a job. Safe to call from any thread.
+     */
+    void queue_upload(std::function<void()> upload);
+
+    /**
+     * Runs queued uploads on the calling (GL) thread until the queue is empty or the time budget runs out.
+     * Prints a load report the first time everything is resident.
+     *
+     * @param budget_ms Time budget for this call, so big scenes stream in instead of stalling a frame.
+     */
+    void process_uploads(int budget_ms = 8);
+
+    /**
+     * Checks if there are jobs or uploads still in flight.
+     */
+    bool is_loading();
+
+    /**
+     * Makes assets be read from a pack. Must be called before any asset is requested.
+     */
+    void mount_pack(std::shared_ptr<scene_pack> pack);
+
+    /**
+     * Looks an asset up in the mounted pack.
+     *
+     * @param filepath Asset path, as written in the config.
+     * @param data Filled with a pointer into the pack, valid for the rest of the program.
+     * @param size Filled with the size of the asset in bytes.
+     *
+     * @returns True if a pack is mounted and has the asset.
+     */
+    bool find_packed(const std::string &filepath, const unsigned char *&data, size_t &size);
+}
+
+#endif
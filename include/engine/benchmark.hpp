@@ -0,0 +1,68 @@
+#ifndef ENGINE_BENCHMARK_HPP
+#define ENGINE_BENCHMARK_HPP
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "external/tinyxml2.h"
+
+#include "engine/bvh.hpp"
+#include "engine/frustum.hpp"
+#include "engine/frustum_kernels.hpp"
+#include "engine/group.hpp"
+#include "engine/scene_graph.hpp"
+#include "engine/work_stealing_pool.hpp"
+
+#include "utils/printer.hpp"
+#include "utils/timing.hpp"
+
+/**
+ * CPU-only engine benchmarks, run before any window or GL context is created.
+ *
+ * Usage: engine --benchmark scene_graph [group_count]
+ *        engine --benchmark update_scaling [group_count] [max_threads]
+ *        engine --benchmark bvh [object_count]
+ *        engine --benchmark cull_kernels [sphere_count]
+ */
+namespace engine_benchmark
+{
+    /**
+     * Runs the benchmark named in argv[2].
+     *
+     * @returns Process exit code.
+     */
+    int run(int argc, char **argv);
+
+    /**
+     * Builds synthetic group hierarchies and compares group::update_group's recursion with
+     * scene_graph::update on fully animated, mostly static and static scenes, checking both give the same positions.
+     */
+    int benchmark_scene_graph(int argc, char **argv);
+
+    /**
+     * Updates a fully animated synthetic scene serially and on work_stealing_pools of 1, 2, 4... threads, reporting the
+     * speedup of each. For each pool, a scene built from its own document is advanced a few frames with a non-zero dt and
+     * every world matrix is checked against an identical scene advanced serially.
+     */
+    int benchmark_update_scaling(int argc, char **argv);
+
+    /**
+     * Times building, refitting and querying a bvh over 10k, 100k and 1M random boxes (or object_count), checking
+     * frustum and ray queries against testing every box. Then lets every box drift for a while and reports how many
+     * subtrees were rebuilt and how the tree compares with a fresh build.
+     */
+    int benchmark_bvh(int argc, char **argv);
+
+    /**
+     * Tests random spheres against a frustum with every frustum_kernels kernel the CPU supports, reporting spheres per
+     * second and checking each one narrows every plane mask exactly like the scalar kernel.
+     */
+    int benchmark_cull_kernels(int argc, char **argv);
+}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "engine/frustum.hpp"
+
+#include "math/vector3.hpp"
+
+#define BVH_SAH_BINS 16           // < -- candidate split planes per axis when building
+#define BVH_REBUILD_GROWTH 1.5f   // < -- a subtree is rebuilt once refitting grew its cost by this factor
+#define BVH_REBUILD_MIN_ITEMS 256 // < -- smaller subtrees are never rebuilt on their own
+#define BVH_NO_ITEM 0xFFFFFFFFu
+
+/**
+ * World space box, see bvh.
+ */
+struct bvh_box
+{
+    vector3 min;
+    vector3 max;
+};
+
+/**
+ * An item that survived frustum culling, with the planes it may still cross (see frustum::cull_sphere).
+ */
+struct bvh_visible
+{
+    uint32_t item;
+    unsigned char planes;
+};
+
+/**
+ * Dynamic bounding volume hierarchy over a fixed set of items, each bounded by an axis aligned box.
+ *
+ * Nodes are binary and stored depth first like scene_graph's groups: a node's left child is right after it, its right
+ * child right after the left one's subtree, and end is one past its last descendant. Every leaf holds one item, so a
+ * subtree over n items is always 2n - 1 nodes, and queries walk the array in order, jumping to end to skip a subtree.
+ *
+ * Building splits each node where the surface area heuristic is lowest, over BVH_SAH_BINS bins per axis. Moving items
+ * only refits the boxes, which is cheap but lets the tree get worse as items drift apart. A subtree's cost is the sum
+ * of its internal nodes' surface areas, what the heuristic minimizes. After each refit the topmost subtrees of at least
+ * BVH_REBUILD_MIN_ITEMS items whose cost grew by BVH_REBUILD_GROWTH since they were built are rebuilt in place, the
+ * rest of the tree is left alone.
+ */
+class bvh
+{
+public:
+    bvh() = default;
+
+    /**
+     * Builds the hierarchy from scratch.
+     *
+     * @param boxes Item i's bounds are boxes[i], item ids are their indices.
+     */
+    void build(std::vector<bvh_box> boxes);
+
+    /**
+     * Getter for an item's box. Change it as items move, then call refit.
+     */
+    bvh_box &item_bounds(uint32_t item) { return items[item]; }
+
+    /**
+     * Recomputes every node's box from the items', then rebuilds subtrees that got too loose.
+     *
+     * @returns Number of subtrees rebuilt.
+     */
+    size_t refit();
+
+    /**
+     * Collects items whose boxes intersect the view frustum. Subtrees entirely inside of some planes don't test them
+     * again, and those planes are dropped from the items' masks too.
+     *
+     * @param visible Visible items are appended here, in no particular order.
+     */
+    void cull(const frustum &view_frustum, std::vector<bvh_visible> &visible) const;
+
+    /**
+     * Finds the item whose box a ray enters first.
+     *
+     * @param direction Ray direction, doesn't need to be normalized (distances are then in its length).
+     * @param max_distance Boxes entered further than this are ignored.
+     * @param item Filled with the item hit, BVH_NO_ITEM if none.
+     * @param distance Filled with the distance along the ray the box is entered at, 0 if the origin is inside it.
+     *
+     * @returns Boolean determining wether an item was hit.
+     */
+    bool raycast(const vector3 &origin, const vector3 &direction, float max_distance, uint32_t &item, float &distance) const;
+
+    /**
+     * Collects items whose boxes are closer than radius to center.
+     *
+     * @param found Items found are appended here, in no particular order.
+     */
+    void query_sphere(const vector3 &center, float radius, std::vector<uint32_t> &found) const;
+
+    size_t get_item_count() const { return items.size(); }
+    size_t get_node_count() const { return nodes.size(); }
+
+    /**
+     * Sum of every internal node's surface area over the root's, the cost of the tree relative to testing the root alone.
+     * Lower is better, used to compare builds.
+     */
+    float get_sah_cost() const;
+
+private:
+    struct node
+    {
+        bvh_box bounds;
+        uint32_t end;  // < -- one past the node's last descendant
+        uint32_t item; // < -- BVH_NO_ITEM for internal nodes
+    };
+
+    std::vector<bvh_box> items;
+    std::vector<node> nodes;
+    std::vector<float> costs;       // < -- sum of the internal nodes' surface areas in each node's subtree, 0 for leaves
+    std::vector<float> built_costs; // < -- the same when the subtree was last built
+    std::vector<uint32_t> order;    // < -- scratch, items being built
+
+    /**
+     * Builds a subtree over order[first, last), writing its nodes from index on.
+     *
+     * @returns One past the subtree's last node.
+     */
+    uint32_t build_node(uint32_t index, uint32_t first, uint32_t last);
+
+    /**
+     * Rebuilds the subtree rooted at index over the same items, in the same nodes.
+     */
+    void rebuild(uint32_t index);
+
+    static float surface_area(const bvh_box &box);
+    static void grow(bvh_box &box, const bvh_box &other);
+};
+
+#endif
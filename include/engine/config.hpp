@@ -3,17 +3,25 @@
 
 #include "external/tinyxml2.h"
 
+#include "engine/asset_loader.hpp"
 #include "engine/group.hpp"
+#include "engine/render_queue.hpp"
+#include "engine/scene_graph.hpp"
+#include "engine/work_stealing_pool.hpp"
 #include "engine/camera.hpp"
 #include "engine/frustum.hpp"
 #include "engine/light.hpp"
+#include "engine/texture_cache.hpp"
 
 #include "math/matrix4x4.hpp"
 #include "math/vector3.hpp"
 #include "math/vector4.hpp"
 
+#include "utils/scene_pack.hpp"
+
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -46,11 +54,9 @@ public:
     vector3 get_projection_settings();
 
     /**
-     * Getter for root groups.
-     *
-     * @returns Vector containing all root groups.
+     * Getter for the flattened group hierarchy.
      */
-    std::vector<group> get_root_groups();
+    const scene_graph &get_scene_graph() const { return scene; }
 
     /**
      * Getter for camera created from config file.
@@ -60,7 +66,7 @@ public:
     camera *get_config_camera_init();
 
     /**
-     * Calls render_group() for all root groups.
+     * Renders every group of the scene graph.
      *
      * @param camera_transform Projection and view transform to be able to properly render bounding sphere.
      * @param view_frustum View frustum to be passed to group rendering. Used in frustum rendering.
@@ -77,7 +83,7 @@ public:
     /**
      * Function responsible for updating all group positions.
      *
-     * It isn't really needed right now, just need to call it once to make sure groups have correct positions.
+     * Large scenes are updated in parallel, see scene_graph.
      */
     void update_groups(int delta_time_ms);
 
@@ -105,7 +111,9 @@ private:
 
     camera *cam; // < -- Camera object created with initial configuration.
 
-    std::vector<group> root_groups; // < -- Vector of all root groups (groups with no parent group)
+    scene_graph scene; // < -- All groups, flattened from the root groups (groups with no parent group)
+    render_queue queue; // < -- kept between frames so its buffers are reused
+    std::unique_ptr<work_stealing_pool> update_pool; // < -- only created when the scene splits into several update tasks
     std::vector<light> lights;
 
     /**
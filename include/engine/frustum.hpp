@@ -1,11 +1,18 @@
 #ifndef FRUSTUM_HPP
 #define FRUSTUM_HPP
 
+#include "engine/frustum_kernels.hpp"
+
 #include "math/vector3.hpp"
 #include "math/vector4.hpp"
 #include "math/matrix4x4.hpp"
 
+#include <cstdint>
 #include <iostream>
+#include <limits>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
 
 #ifdef __APPLE__
 #include <GLUT/glut.h>
@@ -14,6 +21,8 @@
 #include <GL/glut.h>
 #endif
 
+#define FRUSTUM_ALL_PLANES 0x3F // < -- one bit per plane: left, right, top, bottom, near, far
+
 class frustum
 {
 public:
@@ -29,6 +38,51 @@ public:
      */
     bool inside_frustum(vector3 position, float radius);
 
+    /**
+     * Checks if an axis aligned box intersects view frustum. Tighter than the sphere test for flat or elongated meshes.
+     *
+     * @param box_min Box corner with the smallest coordinates, in world space.
+     * @param box_max Box corner with the largest coordinates, in world space.
+     * @param planes Planes to test against, see FRUSTUM_ALL_PLANES.
+     *
+     * @returns Boolean determining wether the box intersects view frustum.
+     */
+    bool inside_frustum(const vector3 &box_min, const vector3 &box_max, unsigned char planes = FRUSTUM_ALL_PLANES) const;
+
+    /**
+     * Sphere test for hierarchies of bounding spheres. Only the planes in planes are tested, and the ones the sphere is
+     * entirely in front of are removed from it, so whatever the sphere encloses doesn't need to test them again.
+     *
+     * @param center Bounding sphere center, in world space.
+     * @param radius Bounding sphere radius.
+     * @param planes Planes left to test, see FRUSTUM_ALL_PLANES. 0 once the sphere is entirely inside the frustum.
+     *
+     * @returns False if the sphere is entirely outside the frustum.
+     */
+    bool cull_sphere(const vector3 &center, float radius, unsigned char &planes) const;
+
+    /**
+     * Same as cull_sphere, for an axis aligned box.
+     *
+     * @param box_min Box corner with the smallest coordinates, in world space.
+     * @param box_max Box corner with the largest coordinates, in world space.
+     * @param planes Planes left to test, see FRUSTUM_ALL_PLANES. 0 once the box is entirely inside the frustum.
+     *
+     * @returns False if the box is entirely outside the frustum.
+     */
+    bool cull_box(const vector3 &box_min, const vector3 &box_max, unsigned char &planes) const;
+
+    /**
+     * Same as cull_sphere, for many spheres at once. Spheres are split into separate coordinate arrays so a SIMD kernel
+     * can test 4 or 8 of them per instruction, see frustum_kernels.
+     *
+     * @param x Sphere centers' x coordinates in world space, the same for y, z and radius.
+     * @param count Number of spheres.
+     * @param planes Planes left to test for each sphere, narrowed like cull_sphere's. FRUSTUM_CULLED once the sphere is
+     *               entirely outside the frustum.
+     */
+    void cull_spheres(const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *planes) const;
+
     /**
      * Function responsible for updating frustum based on projection * view matrix.
      *
@@ -36,11 +90,31 @@ public:
      */
     void update_frustum(matrix4x4 &projection_view_matrix);
 
+    /**
+     * Sets up the projection info needed by projected_size. Call whenever the window or fov changes.
+     *
+     * @param fov Vertical field of view in degrees.
+     * @param viewport_height Viewport height in pixels.
+     */
+    void set_screen_scale(float fov, int viewport_height);
+
+    /**
+     * Estimates how many pixels tall a sphere is on screen.
+     *
+     * @param view_position Sphere center in view space.
+     * @param radius Sphere radius.
+     *
+     * @returns Projected diameter in pixels.
+     */
+    float projected_size(const vector4 &view_position, float radius) const;
+
     /**
      * Draws view frustum outline.
      */
     void draw_frustum();
 
+    static unsigned char cull_kernel; // < -- FRUSTUM_KERNEL_* cull_spheres runs, the fastest one the CPU supports by default
+
 private:
     vector4 left_plane;
     vector4 right_plane;
@@ -49,6 +123,8 @@ private:
     vector4 near_plane;
     vector4 far_plane;
 
+    float screen_scale = 1.0f; // < -- viewport height / (2 * tan(fov / 2))
+
     static vector3 intersect_planes(const vector4 &p1, const vector4 &p2, const vector4 &p3);
 
     void draw_frustum_private(const vector4 planes[6]);
@@ -0,0 +1,63 @@
+#ifndef FRUSTUM_KERNELS_HPP
+#define FRUSTUM_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define FRUSTUM_KERNELS_X86
+#endif
+
+#define FRUSTUM_KERNEL_SCALAR 0
+#define FRUSTUM_KERNEL_SSE 1  // < -- 4 spheres per instruction
+#define FRUSTUM_KERNEL_AVX2 2 // < -- 8 spheres per instruction
+
+#define FRUSTUM_CULLED 0x80 // < -- plane mask of a sphere entirely outside the frustum, see frustum::cull_spheres
+
+/**
+ * Batch sphere against frustum tests, see frustum::cull_spheres. Each kernel computes exactly the same distances in the
+ * same order as frustum::cull_sphere, so they all agree with it and with each other bit for bit. SIMD kernels test every
+ * plane and only then apply each sphere's mask, which gives the same result as skipping the planes.
+ *
+ * SIMD kernels are only compiled for x86, each with its own instruction set enabled, and must only be called once
+ * supported says the CPU has it.
+ */
+namespace frustum_kernels
+{
+    /**
+     * Signature shared by every kernel.
+     *
+     * @param planes Six planes, normal in xyz and distance in w.
+     * @param x Sphere centers' x coordinates, the same for y, z and radius.
+     * @param count Number of spheres.
+     * @param masks One plane mask per sphere, planes left to test on input. Narrowed like frustum::cull_sphere narrows its
+     *              mask, or set to FRUSTUM_CULLED when the sphere is entirely behind one of them.
+     */
+    typedef void (*kernel)(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *masks);
+
+    void cull_scalar(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *masks);
+
+#ifdef FRUSTUM_KERNELS_X86
+    void cull_sse(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *masks);
+    void cull_avx2(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *masks);
+#endif
+
+    /**
+     * Checks if the CPU (and OS) can run a kernel.
+     *
+     * @param kernel_type One of the FRUSTUM_KERNEL_* values.
+     */
+    bool supported(unsigned char kernel_type);
+
+    /**
+     * Getter for a kernel, NULL if it isn't supported.
+     */
+    kernel get(unsigned char kernel_type);
+
+    /**
+     * Name of a kernel, for reports.
+     */
+    const char *name(unsigned char kernel_type);
+}
+
+#endif
@@ -34,15 +34,7 @@ class group
 {
 public:
     group() = delete;
-    group(tinyxml2::XMLElement *root, float parent_scale = 1.0f);
-
-    /**
-     * Function that renders this group, as well as call itself for all subgroups.
-     *
-     * @param view_frustum View frustum to be used in frustum culling.
-     * @param render_bounding_spheres Determines if bounding spheres are rendered.
-     */
-    void render_group(matrix4x4 &camera_transform, frustum &view_frustum, bool frustum_cull = true, bool render_bounding_spheres = false, bool draw_translation_path = false);
+    group(tinyxml2::XMLElement *root);
 
     /**
      * Returns camera lock positions for this group and calls itself for all subgroups.
@@ -57,6 +49,8 @@ public:
     void update_group(int delta_time_ms, matrix4x4 parent_transform);
 
 private:
+    friend class scene_graph; // < -- flattens parsed groups
+
     unsigned int mesh_count = 0; // < -- number of loaded meshes
 
     matrix4x4 model_matrix; // < -- 4 by 4 matrix storing transformations
@@ -67,7 +61,8 @@ private:
     rotation *r = NULL;
     matrix4x4 s; // scale is always static!
 
-    vector3 position; // < -- group position in 3D space.
+    vector3 position;       // < -- group position in 3D space.
+    matrix4x4 world_matrix; // < -- every parent transform times model_matrix, refreshed by update_group
 
     material mat;
 
@@ -90,7 +85,7 @@ private:
      *
      * @param root Group element to parse.
      */
-    void parse_group(tinyxml2::XMLElement *root, float parent_scale = 1.0f);
+    void parse_group(tinyxml2::XMLElement *root);
 };
 
 class FailedToParseGroupException : public std::exception
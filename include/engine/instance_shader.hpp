@@ -0,0 +1,107 @@
+#ifndef INSTANCE_SHADER_HPP
+#define INSTANCE_SHADER_HPP
+
+#include <string>
+
+#ifdef __APPLE__
+#include <GLUT/glut.h>
+#else
+#include <GL/glew.h>
+#include <GL/glut.h>
+#endif
+
+#include "math/vector4.hpp"
+
+#include "utils/printer.hpp"
+
+// generic attribute locations for per-instance data. conventional attributes alias generic ones on some drivers
+// (gl_Vertex 0, gl_Normal 2, gl_Color 3, gl_MultiTexCoord0 8), so those are avoided
+#define INSTANCE_ATTRIBUTE_WORLD 4    // < -- 4 to 7, one world matrix column each
+#define INSTANCE_ATTRIBUTE_MATERIAL 9 // < -- 9 to 12: diffuse, ambient (shininess in w), specular, emission
+
+#define INSTANCE_SHADER_MAX_LIGHTS 8
+
+/**
+ * Per-instance data streamed to the GPU for instanced draws.
+ */
+struct instance_data
+{
+    float world[16];   // < -- model to world transform, column major
+    float diffuse[4];
+    float ambient[4];  // < -- shininess in w
+    float specular[4];
+    float emission[4];
+};
+
+/**
+ * GLSL 1.20 program drawing many placements of one mesh in a single call, with each placement's world matrix and
+ * material read from instanced attributes (see instance_data).
+ *
+ * It reproduces the fixed function lighting the rest of the engine uses (per vertex, local viewer, every enabled light
+ * read from gl_LightSource) and modulates by the bound texture, through the texture matrix like fixed function does.
+ * Needs OpenGL 3.3 for attribute divisors and instanced draws. On older contexts, or if the program doesn't build,
+ * is_ready stays false and render_queue keeps drawing one placement at a time.
+ */
+class instance_shader
+{
+public:
+    instance_shader() = default;
+    ~instance_shader();
+
+    instance_shader(const instance_shader &) = delete;
+    instance_shader &operator=(const instance_shader &) = delete;
+
+    /**
+     * Builds the program the first time it's called. GL thread only.
+     *
+     * @returns True if instanced drawing is available.
+     */
+    bool init();
+
+    bool is_ready() const { return program != 0; }
+
+    /**
+     * Makes the program current and enables the instanced attributes.
+     *
+     * @param light_count Number of lights enabled, from GL_LIGHT0 on.
+     */
+    void begin(int light_count);
+
+    /**
+     * Sets up the program for one mesh.
+     *
+     * @param dequantization Offset (xyz) and scale (w) turning the mesh's stored positions into model space ones.
+     * @param textured Determines if the bound texture modulates the lit color.
+     */
+    void set_mesh(const vector4 &dequantization, bool textured);
+
+    /**
+     * Points the instanced attributes at the bound instance buffer.
+     *
+     * @param first Index of the batch's first instance_data in the buffer.
+     */
+    void set_instances(size_t first);
+
+    /**
+     * Disables the instanced attributes and goes back to fixed function.
+     */
+    void end();
+
+private:
+    GLuint program = 0;
+    bool tried = false;
+
+    GLint dequantization_location = -1;
+    GLint textured_location = -1;
+    GLint light_count_location = -1;
+    GLint texture_unit_location = -1;
+
+    /**
+     * Compiles one stage.
+     *
+     * @returns Shader name, or 0 (after printing the log) if it didn't compile.
+     */
+    static GLuint compile(GLenum type, const char *source);
+};
+
+#endif
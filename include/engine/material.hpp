@@ -23,6 +23,8 @@ public:
     material(vector3 diffuse_component, vector3 ambient_component, vector3 specular_component, vector3 emmissive_component, float shininess);
 
     void apply_material();
+
+    bool operator==(const material &other) const;
 };
 
 #endif
\ No newline at end of file
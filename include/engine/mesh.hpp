@@ -0,0 +1,181 @@
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+#include <GLUT/glut.h>
+#else
+#include <GL/glew.h>
+#include <GL/glut.h>
+#endif
+
+#include "math/vector3.hpp"
+#include "math/vector4.hpp"
+
+#include "utils/printer.hpp"
+#include "utils/mapped_file.hpp"
+#include "utils/model_file.hpp"
+
+/**
+ * CPU side of a .3d file, produced by mesh::read on a worker thread and consumed by mesh::upload.
+ */
+struct mesh_staging
+{
+    mapped_file file;                          // < -- not open when the mesh comes from a pack
+    const unsigned char *bytes = nullptr;      // < -- file contents, in file or inside the pack's mapping
+    const model_file_header *header = nullptr; // < -- points into bytes, null for text files
+    mesh_data data;                            // < -- text files are parsed into this
+    std::vector<float> interleaved;            // < -- built from planar data when the mesh has every attribute
+    std::vector<uint16_t> short_indices;       // < -- narrowed from data.indices when the mesh is small enough
+};
+
+/**
+ * GPU side of a .3d file: vertex, index, normal and texture coordinate buffers plus the bounding sphere and box.
+ *
+ * Both .3d formats are accepted, binary files are detected by their magic number and uploaded straight from the mapping.
+ * Meshes with normals and texture coordinates go into a single interleaved buffer, bound with strided pointers.
+ * Meshes missing some attribute keep one buffer per attribute.
+ * Meshes with at most MODEL_SHORT_INDEX_LIMIT vertices are indexed with GL_UNSIGNED_SHORT.
+ * Quantized binary files are uploaded as they are: GL_SHORT positions scaled back by the modelview matrix in draw(),
+ * GL_INT_2_10_10_10_REV normals and GL_HALF_FLOAT texture coordinates. Contexts without those formats are given floats
+ * instead.
+ * A mesh starts out empty and becomes resident once its upload has run on the GL thread (see asset_loader).
+ *
+ * Meshes own their GL buffers, so they can't be copied. Models share them through mesh_cache.
+ */
+class mesh
+{
+public:
+    mesh() = default;
+    ~mesh();
+
+    mesh(const mesh &) = delete;
+    mesh &operator=(const mesh &) = delete;
+
+    /**
+     * Reads and parses a .3d file. Doesn't touch GL, so it's safe to call from worker threads.
+     *
+     * @param filepath Path to .3d file.
+     * @param staging Filled with the file contents.
+     * @param error Filled with a description of the problem when reading fails.
+     *
+     * @returns True if the file was read.
+     */
+    static bool read(const std::string &filepath, mesh_staging &staging, std::string &error);
+
+    /**
+     * Same as above for a .3d file already in memory, e.g. inside a scene pack.
+     *
+     * @param data Start of the file. Binary files are uploaded straight from it, so it must outlive the staging.
+     * @param size Size of the file in bytes.
+     */
+    static bool read(const unsigned char *data, size_t size, mesh_staging &staging, std::string &error);
+
+    /**
+     * Checks if the GL context can source GL_INT_2_10_10_10_REV normals and GL_HALF_FLOAT texture coordinates (OpenGL
+     * 3.3, or the ARB extensions for both). Quantized files are dequantized by read when it can't. Needs GLEW initialized.
+     */
+    static bool quantized_supported();
+
+    /**
+     * Creates the GL buffers from staged data and marks the mesh as resident. GL thread only.
+     */
+    void upload(const mesh_staging &staging);
+
+    /**
+     * Binds this mesh's buffers and sets up the client state pointers.
+     *
+     * @param use_normals Determines if the normal buffer is bound.
+     * @param use_texture_coordinates Determines if the texture coordinate buffer is bound.
+     */
+    void bind(bool use_normals, bool use_texture_coordinates);
+
+    /**
+     * Issues the draw call. Buffers must have been bound with bind() first, and can be drawn from several times.
+     * Quantized meshes push their dequantization transform around the call.
+     */
+    void draw();
+
+    /**
+     * Draws several instances in one call, for instance_shader. Buffers must have been bound with bind() first.
+     * Quantized positions aren't scaled here, the shader applies get_dequantization itself.
+     */
+    void draw_instanced(GLsizei instance_count);
+
+    /**
+     * Getter for the transform from stored to model space positions.
+     *
+     * @returns Offset in xyz and scale in w. Identity for meshes that aren't quantized.
+     */
+    vector4 get_dequantization() const;
+
+    bool is_resident() const { return resident; }
+    uint32_t get_sort_id() const { return sort_id; } // < -- small unique number, groups draws of the same mesh in render_queue
+    size_t get_triangle_count() const { return object_count / 3; }
+    bool has_normals() const { return normals_loaded; }
+    bool has_texture_coordinates() const { return texture_coordinates_loaded; }
+
+    /**
+     * Getter for the bounding sphere as written in the file (no scaling applied).
+     *
+     * @returns Bounding sphere center in xyz and radius in w.
+     */
+    vector4 get_bounding_sphere() const { return bounding_sphere; }
+
+    /**
+     * Getters for the axis aligned bounding box as written in the file, in model space.
+     */
+    const vector3 &get_aabb_min() const { return aabb_min; }
+    const vector3 &get_aabb_max() const { return aabb_max; }
+
+    /**
+     * Getter for the amount of GPU memory taken by this mesh's buffers.
+     *
+     * @returns Size in bytes of all buffers.
+     */
+    size_t get_buffer_size() const { return buffer_size; }
+
+    /**
+     * Getter for the index memory saved by using 16-bit indices.
+     *
+     * @returns Size in bytes, 0 if the mesh uses 32-bit indices or isn't indexed.
+     */
+    size_t get_index_bytes_saved() const { return index_type == GL_UNSIGNED_SHORT ? object_count * (sizeof(uint32_t) - sizeof(uint16_t)) : 0; }
+
+private:
+    static std::atomic<uint32_t> next_sort_id;
+    const uint32_t sort_id = next_sort_id++;
+
+    GLuint VBO = 0; // < -- holds every attribute when interleaved
+    GLuint EBO = 0;
+    GLuint NORMAL_BUFFER = 0;
+    GLuint TEXTURE_COORDINATE_BUFFER = 0;
+
+    size_t object_count = 0;
+    size_t buffer_size = 0;
+
+    std::atomic<bool> resident{false};
+
+    bool has_ebo = false;
+    GLenum index_type = GL_UNSIGNED_INT;
+    bool interleaved = false;
+    bool quantized = false;
+    GLsizei quantized_stride = 0;
+    vector4 quantization; // < -- position = xyz + snorm16 * w
+    bool normals_loaded = false;
+    bool texture_coordinates_loaded = false;
+
+    vector4 bounding_sphere;
+    vector3 aabb_min;
+    vector3 aabb_max;
+
+    GLuint create_buffer(GLenum target, const void *data, size_t size);
+};
+
+#endif
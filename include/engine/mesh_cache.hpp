@@ -0,0 +1,39 @@
+#ifndef MESH_CACHE_HPP
+#define MESH_CACHE_HPP
+
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "engine/mesh.hpp"
+#include "engine/asset_loader.hpp"
+
+#include "utils/printer.hpp"
+
+/**
+ * Process-wide registry of loaded meshes, keyed by canonical file path.
+ *
+ * Every model referencing the same .3d file gets the same mesh, so a file is parsed and uploaded only once.
+ * The registry only keeps weak references: a mesh is freed when the last model using it is destroyed.
+ */
+namespace mesh_cache
+{
+    /**
+     * Returns the mesh for a file, queueing it on the asset_loader the first time it's requested.
+     * GL thread only.
+     *
+     * @param filepath Path to .3d file, as written in the config file.
+     *
+     * @returns Shared pointer to the mesh. It may not be resident yet.
+     */
+    std::shared_ptr<mesh> acquire(const std::string &filepath);
+
+    /**
+     * Prints cache hits, misses and GPU memory used by unique meshes.
+     */
+    void print_stats();
+}
+
+#endif
@@ -4,12 +4,15 @@
 #define USE_LIGHTING
 // #define IGNORE_FRUSTUM_CULL
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <exception>
 #include <string>
 #include <vector>
+#include <memory>
 
 #ifdef __APPLE__
 #include <GLUT/glut.h>
@@ -21,44 +24,133 @@
 
 #include "engine/material.hpp"
 #include "engine/frustum.hpp"
+#include "engine/mesh.hpp"
+#include "engine/mesh_cache.hpp"
+#include "engine/render_queue.hpp"
+#include "engine/texture.hpp"
+#include "engine/texture_cache.hpp"
 
 #include "external/tinyxml2.h"
 
+#include "math/math_utils.hpp"
 #include "math/vector3.hpp"
 #include "math/vector4.hpp"
 #include "math/matrix4x4.hpp"
 
 #include "utils/printer.hpp"
 
+#define LOD_HYSTERESIS 0.15f // < -- a level only changes once the screen size is this fraction past its threshold
+
+/**
+ * Coarser version of a model's mesh, used while the model is smaller than max_screen_size pixels on screen.
+ */
+struct lod_level
+{
+    std::shared_ptr<mesh> geometry;
+    float max_screen_size;
+};
+
 class model
 {
 public:
     model() = delete;
-    model(tinyxml2::XMLElement *root, float bound_scale_factor);
+    model(tinyxml2::XMLElement *root);
     // non_empty constructor not needed, right?
 
-    void render_model(frustum &view_frustum, bool frustum_cull, vector3 &position, bool render_bounding_sphere, matrix4x4 &camera_transform);
+    /**
+     * Culls the model's box against the view frustum, picks a level of detail and records its draw. Nothing is drawn until
+     * the queue is submitted, except the bounding sphere when asked for.
+     *
+     * @param cull_planes Frustum planes the model's world_sphere still crosses, the caller already culled it (see
+     *                    frustum::cull_spheres).
+     * @param world_matrix Model to world transform of the owning group, must stay valid until the queue is submitted.
+     * @param world_sphere The model's world_bounding_sphere for world_matrix, computed whenever the matrix changes.
+     * @param queue Queue the draw is recorded in.
+     */
+    void queue_model(frustum &view_frustum, bool frustum_cull, unsigned char cull_planes, const matrix4x4 &world_matrix, const vector4 &world_sphere, bool render_bounding_sphere, matrix4x4 &camera_transform, render_queue &queue);
+
+    /**
+     * Computes the world space bounding sphere the model is culled with: the sphere around every resident level's, its
+     * center transformed by the full world matrix and its radius scaled by the matrix's largest axis scale.
+     *
+     * @param world_matrix Model to world transform of the owning group.
+     * @param sphere Filled with the center in xyz and the radius in w.
+     *
+     * @returns False if none of the model's meshes is resident yet, so its bounds aren't known.
+     */
+    bool world_bounding_sphere(const matrix4x4 &world_matrix, vector4 &sphere) const;
+
+    /**
+     * Computes the world space box the model is culled with, around every resident level's box.
+     *
+     * @param world_matrix Model to world transform of the owning group.
+     * @param box_min Filled with the world space corner with the smallest coordinates.
+     * @param box_max Filled with the world space corner with the largest coordinates.
+     *
+     * @returns False if none of the model's meshes is resident yet, so its bounds aren't known.
+     */
+    bool world_bounds(const matrix4x4 &world_matrix, vector3 &box_min, vector3 &box_max) const;
+
+    /**
+     * Checks if every level is resident, so the bounds above can't grow anymore and are safe to cache.
+     */
+    bool bounds_final() const;
+
+    static bool lod_enabled;       // < -- when false the full detail mesh is always drawn
+    static size_t triangles_drawn; // < -- running count, reset by whoever reports it
 
 private:
-    GLuint VBO = 0;
-    GLuint EBO = 0;
-    GLuint NORMAL_BUFFER = 0;
-    GLuint TEXTURE_COORDINATE_BUFFER = 0;
+    std::shared_ptr<mesh> geometry; // < -- shared between all models using the same file (see mesh_cache)
 
-    GLuint TEXTURE = 0;
-    size_t object_count = 0;
+    std::vector<lod_level> lods; // < -- from finest to coarsest, not including geometry
+    size_t current_lod = 0;      // < -- 0 is geometry, i is lods[i - 1]
 
-    bool has_ebo = false;
-    bool has_normals = false;
-    bool has_texture_coordinates = false;
+    std::shared_ptr<texture> tex; // < -- shared between all models using the same image (see texture_cache)
 
     material mat;
 
-    vector4 bounding_sphere;
-
-    void parse_model(tinyxml2::XMLElement *root, float bound_scale_factor);
-    void parse_file(const std::string &filepath, float bound_scale_factor);
-    void load_texture(const std::string &filepath);
+    void parse_model(tinyxml2::XMLElement *root);
+
+    /**
+     * Encloses the bounds of every resident level, in model space.
+     *
+     * @param sphere Filled with the center in xyz and the radius in w.
+     * @param box_min Filled with the corner with the smallest coordinates.
+     * @param box_max Filled with the corner with the largest coordinates.
+     *
+     * @returns False if no level is resident yet.
+     */
+    bool local_bounds(vector4 &sphere, vector3 &box_min, vector3 &box_max) const;
+
+    /**
+     * Transforms a model space box into the world space box that encloses it.
+     *
+     * @param local_min Model space corner with the smallest coordinates, the same for local_max.
+     * @param world_matrix Model to world transform.
+     * @param box_min Filled with the world space corner with the smallest coordinates.
+     * @param box_max Filled with the world space corner with the largest coordinates.
+     */
+    static void world_bounding_box(const vector3 &local_min, const vector3 &local_max, const matrix4x4 &world_matrix, vector3 &box_min, vector3 &box_max);
+
+    /**
+     * Length of the longest of a matrix's transformed axes, how much it grows distances at most.
+     */
+    static float max_axis_scale(const matrix4x4 &world_matrix);
+
+    /**
+     * Updates current_lod for the model's current screen size, with hysteresis around every threshold.
+     *
+     * @param screen_size Projected diameter of the model in pixels.
+     */
+    void select_lod(float screen_size);
+
+    /**
+     * Getter for the mesh of a level.
+     *
+     * @param level 0 for the full detail mesh.
+     */
+    std::shared_ptr<mesh> &lod_geometry(size_t level) { return level == 0 ? geometry : lods[level - 1].geometry; }
+    const std::shared_ptr<mesh> &lod_geometry(size_t level) const { return level == 0 ? geometry : lods[level - 1].geometry; }
 };
 
 class FailedToParseModelException : std::exception
@@ -0,0 +1,115 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __APPLE__
+#include <GLUT/glut.h>
+#else
+#include <GL/glew.h>
+#include <GL/glut.h>
+#endif
+
+#include "engine/instance_shader.hpp"
+#include "engine/material.hpp"
+#include "engine/mesh.hpp"
+#include "engine/texture.hpp"
+
+#include "math/matrix4x4.hpp"
+
+#define RENDER_INSTANCING_MIN 2 // < -- placements of one mesh and texture needed to draw them as a single instanced call
+
+/**
+ * Everything needed to issue one draw, recorded by model::queue_model after culling and level of detail selection.
+ */
+struct draw_record
+{
+    uint64_t key;                   // < -- state sort key, see render_queue
+    mesh *geometry;
+    const texture *tex;             // < -- nullptr when drawn untextured
+    uint32_t material_index;        // < -- into render_queue's interned materials
+    bool use_normals;
+    const matrix4x4 *world_matrix;  // < -- owned by the scene graph, valid until the frame is submitted
+};
+
+/**
+ * Per-frame list of draws, sorted by GL state before submission so consecutive draws share as much state as possible.
+ *
+ * Keys hold, from most to least significant, the texture's GL name (atlas page for atlased textures), the texture itself,
+ * the mesh and the material, so textures change least often and every placement of a mesh with a texture ends up in one
+ * run, atlased or not. Keys are sorted with an LSD radix sort, byte by byte, skipping bytes every key has in common.
+ *
+ * Lit runs of at least RENDER_INSTANCING_MIN placements are drawn with a single instanced call: their world matrices
+ * and materials are streamed into an instance buffer, once per frame, and read by instance_shader. Everything else, or
+ * everything when instancing isn't available, is drawn one placement at a time. Either way a mesh is only bound, a
+ * material applied or a texture bound when it differs from the previous draw's.
+ */
+class render_queue
+{
+public:
+    render_queue() = default;
+    ~render_queue();
+
+    render_queue(const render_queue &) = delete;
+    render_queue &operator=(const render_queue &) = delete;
+
+    /**
+     * Drops last frame's draws. Interned materials are kept.
+     */
+    void clear();
+
+    /**
+     * Records a draw.
+     *
+     * @param geometry Resident mesh to draw.
+     * @param tex Resident texture, or nullptr to draw untextured.
+     * @param mat Material, only applied when the mesh has normals.
+     * @param world_matrix Model to world transform, must stay valid until submit.
+     */
+    void push(mesh &geometry, const texture *tex, const material &mat, const matrix4x4 &world_matrix);
+
+    /**
+     * Sorts the recorded draws by state key.
+     */
+    void sort();
+
+    /**
+     * Issues every draw in sorted order, with the camera transform already on the GL matrix stack. GL thread only.
+     * Leaves texturing disabled, the texture matrix as identity and fixed function active.
+     */
+    void submit();
+
+    size_t get_draw_count() const { return records.size(); }
+
+    static size_t draws;         // < -- running count of draw calls, reset by whoever reports it
+    static size_t instanced;     // < -- placements drawn through instanced calls, reset along with draws
+    static size_t state_changes; // < -- mesh binds, material applications and texture binds actually issued
+
+private:
+    std::vector<draw_record> records;
+    std::vector<draw_record> sort_buffer; // < -- radix sort scratch space, kept between frames
+    std::vector<material> materials;      // < -- every distinct material pushed so far
+
+    struct instance_batch
+    {
+        size_t begin;          // < -- range of records
+        size_t end;
+        size_t first_instance; // < -- into instances
+    };
+
+    instance_shader shader;
+    GLuint instance_buffer = 0;
+    size_t instance_buffer_size = 0;       // < -- bytes allocated for instance_buffer
+    std::vector<instance_data> instances;  // < -- this frame's instances, uploaded in one go
+    std::vector<instance_batch> batches;   // < -- this frame's instanced runs, in record order
+
+    /**
+     * Finds the runs worth instancing and uploads their instance data.
+     */
+    void prepare_instances();
+
+    uint32_t intern_material(const material &mat);
+};
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef SCENE_GRAPH_HPP
+#define SCENE_GRAPH_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#ifdef __APPLE__
+#include <GLUT/glut.h>
+#else
+#include <GL/glew.h>
+#include <GL/glut.h>
+#endif
+
+#include "engine/bvh.hpp"
+#include "engine/frustum.hpp"
+#include "engine/group.hpp"
+#include "engine/model.hpp"
+#include "engine/render_queue.hpp"
+#include "engine/transforms/rotation.hpp"
+#include "engine/transforms/translation.hpp"
+#include "engine/work_stealing_pool.hpp"
+
+#include "math/math_utils.hpp"
+#include "math/matrix4x4.hpp"
+#include "math/vector3.hpp"
+#include "math/vector4.hpp"
+
+#define SCENE_GRAPH_TASK_GRAIN 512      // < -- moving groups per parallel update task, smaller subtrees are batched together
+#define SCENE_GRAPH_BVH_MIN_MODELS 4096 // < -- scenes with at least this many models are culled through a bvh
+
+/**
+ * Parsed group hierarchy flattened into arrays, one entry per group.
+ *
+ * Groups are stored depth first, so every parent comes before its children and a group's descendants are the entries
+ * right after it, up to subtree_end. Updating is then a single pass in order: each world matrix is the (already
+ * updated) parent's times the local one. Each group's models are a contiguous range of models.
+ *
+ * Static transforms are baked into the local matrix once. Only groups that are animated, or have an animated ancestor,
+ * can ever move, and since that never changes after parsing they're listed once and update only walks that list.
+ *
+ * A group only depends on its parent, so subtrees can be updated in parallel. The moving groups are split once: groups
+ * above subtrees with more than SCENE_GRAPH_TASK_GRAIN moving groups are updated first, on the calling thread, then the
+ * subtrees below them, batched into tasks of about that size, are spread over a work_stealing_pool. Every group is still
+ * computed by exactly one thread with the same math, so results match the serial update bit for bit.
+ *
+ * Every group also has a world space sphere around its models and all of its descendants', kept up to date after each
+ * update (only for moving groups and their ancestors, once every level of every mesh is resident). Rendering walks the
+ * groups in order and rejects a whole subtree with a single sphere test; planes a subtree is entirely inside of aren't
+ * tested again below it. The models of the surviving groups are culled in SIMD batches (frustum::cull_spheres), one
+ * per run of consecutive groups, then their boxes against the planes their spheres still cross, and queued into a
+ * render_queue, which sorts the draws by GL state before issuing them.
+ *
+ * The hierarchy the file describes isn't always a good culling hierarchy: a big flat group, or thousands of objects
+ * moving independently, leaves little to reject at once. Scenes with at least SCENE_GRAPH_BVH_MIN_MODELS models get a
+ * bvh over every model's world box once every level is resident, refitted after each update and walked instead of the
+ * groups; the spheres of the models it keeps are gathered into one batch. It can also answer ray and proximity queries.
+ */
+class scene_graph
+{
+public:
+    scene_graph() = default;
+
+    /**
+     * Flattens parsed groups. Takes over their transforms, the groups shouldn't be updated afterwards.
+     *
+     * @param roots Groups with no parent group.
+     */
+    explicit scene_graph(const std::vector<group> &roots);
+
+    /**
+     * Advances every animated transform and recomputes the local matrices of animated groups and the world matrices of
+     * every group that can move. Everything else keeps the matrices baked when the graph was built.
+     */
+    void update(int delta_time_ms);
+
+    /**
+     * Same as above, with the subtrees under the top of the hierarchy updated in parallel.
+     *
+     * @param pool Pool running the subtree tasks. Falls back to the serial update when there's only one task.
+     */
+    void update(int delta_time_ms, work_stealing_pool &pool);
+
+    /**
+     * Culls subtrees and then models, then draws the survivors sorted by GL state, each with its group's world matrix
+     * loaded on top of the current GL matrix (the camera's). Translation paths are drawn right away.
+     *
+     * @param camera_transform Projection and view transform to be able to properly render bounding spheres.
+     * @param view_frustum View frustum used in frustum culling.
+     * @param queue Queue the draws are recorded in, cleared first.
+     */
+    void render(matrix4x4 &camera_transform, frustum &view_frustum, render_queue &queue, bool frustum_cull = true, bool render_bounding_spheres = false, bool draw_translation_path = false);
+
+    /**
+     * Returns camera lock positions, one per group, in the same order group::query_group_positions gave them.
+     */
+    std::vector<vector3> query_positions() const;
+
+    size_t get_group_count() const { return parents.size(); }
+    size_t get_moving_count() const { return moving.size(); }
+    size_t get_update_task_count() const { return update_tasks.size(); }
+    const matrix4x4 &get_world_matrix(size_t index) const { return world_matrices[index]; }
+
+    /**
+     * Getter for the spatial index, item i is models[i] of the group get_model_group(i). Empty until it's built, and
+     * for scenes too small to need one.
+     */
+    const bvh &get_index() const { return index; }
+    uint32_t get_model_group(uint32_t model) const { return model_groups[model]; }
+
+private:
+    // one entry per group, parents first
+    std::vector<int32_t> parents;                            // < -- index of the parent group, -1 for root groups
+    std::vector<uint32_t> subtree_ends;                      // < -- one past the group's last descendant
+    std::vector<std::array<unsigned char, 3>> transform_orders;
+    std::vector<translation *> translations;                 // < -- NULL when the group has none
+    std::vector<rotation *> rotations;                       // < -- NULL when the group has none
+    std::vector<matrix4x4> scales;
+    std::vector<matrix4x4> local_matrices;                   // < -- translation, rotation and scale in file order
+    std::vector<matrix4x4> world_matrices;                   // < -- every parent's local matrix times this one's
+    std::vector<uint32_t> model_begins;                      // < -- first model of the group in models
+    std::vector<uint32_t> model_ends;
+    std::vector<unsigned char> animated;                     // < -- the group's own translation or rotation is animated
+
+    std::vector<uint32_t> moving; // < -- groups that are animated or have an animated ancestor, parents first
+
+    std::vector<vector4> subtree_bounds; // < -- world space, w < 0 when there's no model below, infinite while unknown
+    std::vector<uint32_t> rebound;       // < -- groups whose bounds can move: moving groups and their ancestors, children first
+    bool bounds_complete = false;        // < -- every level of every mesh was resident last time all bounds were computed
+    std::vector<unsigned char> cull_planes; // < -- per frame, planes each visited group's subtree may still be outside of
+
+    struct update_task
+    {
+        uint32_t begin; // < -- range of moving, whole subtrees whose parents are already up to date
+        uint32_t end;
+    };
+
+    std::vector<uint32_t> serial_moving;   // < -- moving groups above the parallel subtrees, parents first
+    std::vector<update_task> update_tasks;
+
+    std::vector<model> models;           // < -- every group's models, in group order
+    std::vector<uint32_t> model_groups;  // < -- group of each model
+
+    bvh index;                        // < -- over every model's world box, once built the group bounds aren't kept up to date
+    std::vector<bvh_visible> visible; // < -- per frame, models the bvh didn't cull
+
+    // every model's world space bounding sphere, one array per coordinate for frustum::cull_spheres
+    std::vector<float> sphere_xs;
+    std::vector<float> sphere_ys;
+    std::vector<float> sphere_zs;
+    std::vector<float> sphere_radii;         // < -- infinite until the model is resident
+    std::vector<unsigned char> model_planes; // < -- per frame, planes each model may still cross, see frustum::cull_spheres
+
+    // per frame, the spheres of the models the bvh didn't cull, in the same order as visible
+    std::vector<float> visible_xs;
+    std::vector<float> visible_ys;
+    std::vector<float> visible_zs;
+    std::vector<float> visible_radii;
+    std::vector<unsigned char> visible_planes;
+
+    /**
+     * Appends a group and, after it, all of its descendants.
+     *
+     * @param parent Index of the group's parent, -1 for root groups.
+     */
+    void append(const group &node, int32_t parent);
+
+    /**
+     * Splits the moving groups of a subtree between serial_moving and update_tasks, see the class description.
+     *
+     * @param first First group of a run of siblings.
+     * @param last One past the last group of the run.
+     */
+    void partition(uint32_t first, uint32_t last);
+
+    /**
+     * Number of moving groups with indices in [first, last).
+     */
+    uint32_t moving_between(uint32_t first, uint32_t last) const;
+
+    /**
+     * Recomputes the bounds that may have changed since the last update: the rebound groups', or all of them while some
+     * mesh isn't resident yet.
+     */
+    void refresh_bounds();
+
+    /**
+     * Builds the bvh over every model's current world box.
+     */
+    void build_index();
+
+    /**
+     * Recomputes a group's bounds from its models and its children's bounds, which must be up to date.
+     *
+     * @returns False if one of the group's own models isn't resident yet, or some of its levels aren't (see
+     *          model::bounds_final).
+     */
+    bool update_bounds(uint32_t index);
+
+    /**
+     * Recomputes a model's world space bounding sphere from its group's world matrix.
+     *
+     * @returns False if the model isn't resident yet.
+     */
+    bool update_model_sphere(uint32_t model_index, uint32_t group_index);
+
+    /**
+     * Advances a moving group's transforms if it's animated, then recomputes its world matrix.
+     */
+    void update_group(uint32_t index, int delta_time_ms);
+
+    /**
+     * Rebuilds a group's local matrix from its transforms, in file order.
+     */
+    void compose_local(size_t index);
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef TEXTURE_HPP
+#define TEXTURE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+#include <GLUT/glut.h>
+#else
+#include <GL/glew.h>
+#include <GL/glut.h>
+#include <IL/il.h>
+#endif
+
+#include "utils/printer.hpp"
+#include "utils/mapped_file.hpp"
+#include "utils/texture_file.hpp"
+
+#include "math/vector4.hpp"
+
+/**
+ * Full RGBA8 mip chain, produced by texture::read on a worker thread and consumed by texture::upload.
+ * Either mapped from an up to date .3dt cache file or decoded and filtered from the source image.
+ */
+struct texture_staging
+{
+    mapped_file file;                       // < -- cache file, only open when the chain comes from it
+    mip_chain decoded;                      // < -- filled when the source image had to be decoded
+    const unsigned char *base = nullptr;    // < -- level offsets are relative to this
+    std::vector<texture_file_level> levels; // < -- base level first
+    bool from_cache = false;
+};
+
+/**
+ * GL texture decoded from an image file.
+ *
+ * Decoding and mipmapping happen once per image: the resulting chain is saved next to it as a .3dt file (see
+ * texture_file) and later runs upload that directly, as long as the image hasn't changed.
+ * The pixels only live until they are uploaded, after that the texture is GPU-only.
+ * A texture becomes resident once its upload has run on the GL thread (see asset_loader).
+ * Small textures may instead be placed on a shared atlas page (see texture_atlas), in which case they only remember
+ * where on the page they are.
+ * Textures own their GL name, so they can't be copied. Models share them through texture_cache.
+ */
+class texture
+{
+public:
+    texture() = default;
+    ~texture();
+
+    texture(const texture &) = delete;
+    texture &operator=(const texture &) = delete;
+
+    /**
+     * Loads an image's mip chain from its .3dt cache file, or decodes it to RGBA8, builds the chain and rewrites the cache
+     * when the cache is missing or stale. Doesn't touch GL, so it's safe to call from worker threads.
+     *
+     * DevIL keeps global state, so decodes are serialized internally.
+     *
+     * @param filepath Path to image file.
+     * @param staging Filled with the mip chain.
+     *
+     * @returns True if the image was loaded.
+     */
+    static bool read(const std::string &filepath, texture_staging &staging);
+
+    /**
+     * Same as above for an encoded image already in memory, e.g. inside a scene pack. The format is detected from the data,
+     * .3dt files are used as they are. Nothing is cached, the data must outlive the staging.
+     *
+     * @param data Start of the encoded image.
+     * @param size Size of the encoded image in bytes.
+     */
+    static bool read(const unsigned char *data, size_t size, texture_staging &staging);
+
+    /**
+     * Creates the GL texture from a staged mip chain, one glTexImage2D per level, and marks the texture as resident.
+     * GL thread only.
+     */
+    void upload(const texture_staging &staging);
+
+    /**
+     * Makes the texture a region of an atlas page instead of a GL texture of its own, and marks it as resident.
+     * GL thread only.
+     *
+     * @param page Resident atlas page.
+     * @param width Size of the original image.
+     * @param height Size of the original image.
+     * @param uv_transform Scale (x, y) and offset (z, w) mapping the texture's coordinates onto the page.
+     */
+    void place(std::shared_ptr<texture> page, unsigned int width, unsigned int height, const vector4 &uv_transform);
+
+    /**
+     * Binds the texture (its page, if atlased) to GL_TEXTURE_2D, unless it's bound already.
+     * GL thread only.
+     */
+    void bind() const;
+
+    bool is_resident() const { return resident; }
+    bool is_atlased() const { return page != nullptr; }
+
+    /**
+     * Getter for the transform from the texture's own coordinates to its page's, see place.
+     */
+    const vector4 &get_uv_transform() const { return uv_transform; }
+
+    GLuint get_id() const { return page ? page->get_id() : id; }
+    uint32_t get_sort_id() const { return sort_id; } // < -- small unique number, separates textures on one page in render_queue
+    unsigned int get_width() const { return width; }
+    unsigned int get_height() const { return height; }
+
+    /**
+     * Getter for the GPU memory taken by this texture, mipmaps included.
+     *
+     * @returns Size in bytes.
+     */
+    size_t get_memory_size() const { return memory_size; }
+
+    static size_t binds; // < -- running count of glBindTexture calls actually made
+
+private:
+    static std::atomic<uint32_t> next_sort_id;
+    const uint32_t sort_id = next_sort_id++;
+
+    GLuint id = 0; // < -- stays 0 for atlased textures, the page owns the GL name
+
+    std::shared_ptr<texture> page;
+    vector4 uv_transform = vector4(1.0f, 1.0f, 0.0f, 0.0f);
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+    size_t memory_size = 0;
+
+    std::atomic<bool> resident{false};
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "engine/texture.hpp"
+#include "engine/asset_loader.hpp"
+
+#include "utils/printer.hpp"
+#include "utils/skyline_packer.hpp"
+
+#define TEXTURE_ATLAS_MAX_SIZE 512   // < -- textures no bigger than this on both sides are packed into pages
+#define TEXTURE_ATLAS_PAGE_SIZE 2048
+#define TEXTURE_ATLAS_PADDING 8      // < -- edge texels repeated around each texture, so filtering never reads a neighbour
+#define TEXTURE_ATLAS_MAX_LEVEL 3    // < -- at level 3 the padding is a single texel, deeper levels would bleed
+
+/**
+ * A texture waiting to be placed on an atlas page, with its decoded mip chain.
+ */
+struct atlas_entry
+{
+    std::shared_ptr<texture> target;
+    std::shared_ptr<texture_staging> staging;
+};
+
+/**
+ * Packs the small textures of a scene into a few shared pages, so models using different images can be drawn without
+ * rebinding. Each placed texture keeps its own object, it only points at its page and remaps its texture coordinates
+ * (see texture::place).
+ *
+ * Atlased textures can't repeat, so texture_cache only packs textures every requesting model opted in for. Pages only
+ * have mip levels down to TEXTURE_ATLAS_MAX_LEVEL (1/8 scale), so an atlased texture drawn smaller than that aliases
+ * where a standalone one would keep filtering; textures that are mostly seen from far away shouldn't opt in.
+ */
+namespace texture_atlas
+{
+    /**
+     * Checks if a staged texture is small enough to be atlased.
+     */
+    bool is_candidate(const texture_staging &staging);
+
+    /**
+     * Packs textures into pages and builds each page's mip chain, then queues one upload that creates the pages and places
+     * every texture. Textures that don't fit, or a lone candidate, are uploaded on their own.
+     * CPU only, meant to run on a worker thread.
+     */
+    void build(std::vector<atlas_entry> entries);
+
+    /**
+     * Prints the number of pages, their occupancy and how many textures share them.
+     */
+    void print_stats();
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "engine/texture.hpp"
+#include "engine/asset_loader.hpp"
+#include "engine/texture_atlas.hpp"
+
+#include "utils/printer.hpp"
+
+/**
+ * Process-wide registry of loaded textures, keyed by canonical file path.
+ *
+ * Every model using the same image gets the same GL texture, so each file is decoded and uploaded only once.
+ * Like mesh_cache, only weak references are kept.
+ *
+ * Small textures requested while a config loads, by models that opt in with <texture file="..." atlas="true"/>, are
+ * held back and packed into atlas pages once the config is done (see finish_requests and texture_atlas).
+ */
+namespace texture_cache
+{
+    /**
+     * Returns the texture for an image file, queueing it on the asset_loader the first time it's requested.
+     * GL thread only.
+     *
+     * @param filepath Path to the image, as written in the config file.
+     * @param atlas True if the requesting model's texture coordinates stay inside [0, 1], so the texture may be packed
+     *              into an atlas page. It's only packed if every request before finish_requests allows it.
+     *
+     * @returns Shared pointer to the texture. It may not be resident yet.
+     */
+    std::shared_ptr<texture> acquire(const std::string &filepath, bool atlas = false);
+
+    /**
+     * Marks the end of a config's texture requests. Once every texture requested so far has been read, the small ones
+     * are packed into atlas pages and uploaded; later requests are uploaded on their own.
+     * GL thread only.
+     */
+    void finish_requests();
+
+    /**
+     * Prints cache hits and misses, and the memory used by each resident texture.
+     */
+    void print_stats();
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads running queued tasks in submission order.
+ */
+class thread_pool
+{
+public:
+    thread_pool() = delete;
+
+    /**
+     * Starts the worker threads.
+     *
+     * @param thread_count Number of workers. 0 means one per hardware thread.
+     */
+    thread_pool(size_t thread_count);
+
+    /**
+     * Finishes every queued task, then joins the workers.
+     */
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    /**
+     * Queues a task to be run by a worker.
+     */
+    void submit(std::function<void()> task);
+
+    size_t get_thread_count() const { return workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+
+    std::mutex tasks_mutex;
+    std::condition_variable tasks_available;
+    bool stopping = false;
+
+    void worker_loop();
+};
+
+#endif
@@ -11,6 +11,7 @@ class rotation
 {
 public:
     virtual void update(int delta_time_ms) = 0;
+    virtual bool is_animated() const = 0; // < -- false when update never changes the matrix
     virtual matrix4x4 get_rotation() = 0;
 
     virtual operator const matrix4x4() const = 0;
@@ -9,6 +9,7 @@ public:
     rotation_dynamic(float time, vector3 rotation_vector);
 
     void update(int delta_time_ms) override;
+    bool is_animated() const override { return true; }
     matrix4x4 get_rotation() override;
 
     operator const matrix4x4() const override;
@@ -9,6 +9,7 @@ public:
     rotation_static(float angle, vector3 rotation_vector);
 
     void update(int delta_time_ms) override { return; } // static rotation doesn't need to be updated
+    bool is_animated() const override { return false; }
     matrix4x4 get_rotation() override;
 
     operator const matrix4x4() const override;
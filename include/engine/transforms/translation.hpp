@@ -25,6 +25,7 @@ class translation
 {
 public:
     virtual void update(int delta_time_ms) = 0;
+    virtual bool is_animated() const = 0; // < -- false when update never changes the matrix
     virtual matrix4x4 get_translation() = 0;
     virtual void draw_path() = 0;
 
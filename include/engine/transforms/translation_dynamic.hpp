@@ -9,6 +9,7 @@ public:
     translation_dynamic(float total_time, bool align, std::vector<vector3> points, bool loop, int path_divisions = PATH_DIVISIONS);
 
     void update(int delta_time_ms) override;
+    bool is_animated() const override { return true; }
     matrix4x4 get_translation() override;
     void draw_path() override;
 
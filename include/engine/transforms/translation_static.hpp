@@ -9,6 +9,7 @@ public:
     translation_static(vector3 translation_vector);
 
     void update(int delta_time_ms) override { return; }
+    bool is_animated() const override { return false; }
     matrix4x4 get_translation() override;
     void draw_path() override { return; }
 
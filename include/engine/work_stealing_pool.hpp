@@ -0,0 +1,84 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fork/join pool for batches of independent tasks, used for per-frame work (see scene_graph::update).
+ *
+ * Unlike thread_pool, a batch is split up front: every participant gets its own queue of contiguous tasks, works
+ * through it from the back, and once it's empty steals from the front of the others. The calling thread takes part
+ * too, and run returns once the whole batch is done.
+ */
+class work_stealing_pool
+{
+public:
+    work_stealing_pool() = delete;
+
+    /**
+     * Starts the worker threads.
+     *
+     * @param thread_count Threads running a batch, the calling one included. 0 means one per hardware thread.
+     */
+    work_stealing_pool(size_t thread_count);
+
+    /**
+     * Joins the workers. Must not be called while a batch is running.
+     */
+    ~work_stealing_pool();
+
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+    /**
+     * Runs task(0) to task(task_count - 1) across every thread and waits for all of them.
+     * Tasks may run in any order and on any thread. Only one batch can run at a time.
+     */
+    void run(size_t task_count, const std::function<void(size_t)> &task);
+
+    size_t get_thread_count() const { return queues.size(); }
+
+private:
+    struct task_queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<task_queue>> queues; // < -- one per participant, 0 is the thread calling run
+    std::vector<std::thread> workers;
+
+    std::mutex batch_mutex;
+    std::condition_variable batch_started;
+    std::condition_variable batch_finished;
+    uint64_t batch = 0;                              // < -- incremented whenever a batch starts
+    const std::function<void(size_t)> *current = nullptr;
+    std::atomic<size_t> remaining{0};                // < -- tasks of the current batch not finished yet
+    bool stopping = false;
+
+    void worker_loop(size_t index);
+
+    /**
+     * Runs tasks, own ones first then stolen ones, until every queue is empty.
+     *
+     * @param index Queue of the calling participant.
+     */
+    void drain(size_t index);
+
+    /**
+     * Takes a task from the back of the participant's own queue, or else from the front of another one.
+     *
+     * @returns False if every queue is empty.
+     */
+    bool next_task(size_t index, size_t &task);
+};
+
+#endif
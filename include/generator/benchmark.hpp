@@ -0,0 +1,45 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+
+#include "generator/shape_generator.hpp"
+
+#include "utils/mapped_file.hpp"
+#include "utils/model_file.hpp"
+#include "utils/mesh_optimizer.hpp"
+#include "utils/mesh_simplifier.hpp"
+#include "utils/timing.hpp"
+
+/**
+ * Not a shape: runs asset pipeline benchmarks.
+ *
+ * Usage: generator benchmark parse <file.3d> [file.3d ...]
+ *        generator benchmark quantize <file.3d> [file.3d ...]
+ *        generator benchmark simplify <file.3d> [ratio ...]
+ */
+class benchmark_tool : public shape_generator
+{
+public:
+    void generate(int argc, char **argv) override;
+
+private:
+    /**
+     * Compares text .3d parse throughput of the old stringstream parser and model_file::parse_text.
+     */
+    void benchmark_parse(int argc, char **argv);
+
+    /**
+     * Round trips meshes through the quantized binary format and reports the worst errors and memory saved.
+     */
+    void benchmark_quantize(int argc, char **argv);
+
+    /**
+     * Simplifies a mesh to several ratios and reports the time taken and the Hausdorff error of each result.
+     */
+    void benchmark_simplify(int argc, char **argv);
+};
+
+#endif
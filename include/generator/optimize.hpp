@@ -0,0 +1,17 @@
+#ifndef OPTIMIZE_HPP
+#define OPTIMIZE_HPP
+
+#include "generator/shape_generator.hpp"
+
+/**
+ * Not a shape: welds duplicate vertices of an existing .3d file and reorders it for the post-transform vertex cache and vertex fetch.
+ *
+ * Usage: generator optimize <in.3d> <out.3d>
+ */
+class optimize_tool : public shape_generator
+{
+public:
+    void generate(int argc, char **argv) override;
+};
+
+#endif
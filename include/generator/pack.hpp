@@ -0,0 +1,40 @@
+#ifndef PACK_HPP
+#define PACK_HPP
+
+#include <unordered_set>
+
+#include "generator/shape_generator.hpp"
+
+#include "external/tinyxml2.h"
+
+#include "utils/scene_pack.hpp"
+#include "utils/texture_file.hpp"
+#include "utils/mapped_file.hpp"
+
+/**
+ * Not a shape: bundles a scene config and every mesh and texture it references (model, lod and texture file
+ * attributes) into a single .pack file the engine can open instead of the config.
+ *
+ * Paths are resolved like the engine does, relative to the working directory. Textures with an up to date .3dt mip
+ * cache (written by the engine the first time it loads them) are stored as that cache instead of the source image.
+ *
+ * Usage: generator pack <config.xml> <out.pack>
+ */
+class pack_tool : public shape_generator
+{
+public:
+    void generate(int argc, char **argv) override;
+
+private:
+    /**
+     * Adds the file attribute of every asset element under root (recursively) to sources, once per name.
+     */
+    void collect_assets(tinyxml2::XMLElement *root, std::vector<scene_pack_source> &sources, std::unordered_set<std::string> &seen);
+
+    /**
+     * Picks the file to store for a texture: its .3dt mip cache if it's up to date, the image itself otherwise.
+     */
+    std::string cached_texture(const std::string &filepath);
+};
+
+#endif
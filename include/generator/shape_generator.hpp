@@ -16,6 +16,8 @@
 #include "math/math_utils.hpp"
 
 #include "utils/printer.hpp"
+#include "utils/model_file.hpp"
+#include "utils/mesh_optimizer.hpp"
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -26,6 +28,16 @@ public:
     virtual void generate(int argc, char **argv) = 0;
     virtual ~shape_generator() = default;
 
+    /**
+     * Sets the format generated files are written in. Text by default.
+     */
+    void set_output_format(model_file::format format) { output_format = format; }
+
+    /**
+     * Sets if meshes are welded and reordered for the vertex cache before being written. On by default.
+     */
+    void set_optimize(bool optimize) { optimize_output = optimize; }
+
     static bool validate_filepath(const std::string &filepath, const std::string &extention = ".3d")
     {
         if (filepath.length() <= extention.length())
@@ -34,6 +46,28 @@ public:
         }
         return filepath.compare(filepath.length() - extention.length(), extention.length(), extention) == 0;
     }
+
+protected:
+    model_file::format output_format = model_file::FORMAT_TEXT;
+    bool optimize_output = true;
+
+    /**
+     * Writes a mesh to a .3d file in the selected output format, welding and optimizing it first if enabled.
+     * Bounds are recomputed from the vertices (see model_file::compute_bounds).
+     *
+     * @param filepath Output .3d file path.
+     * @param data Mesh to write. Reordered in place when optimizing.
+     */
+    void write_mesh(const std::string &filepath, mesh_data &data);
+
+    /**
+     * Writes generated geometry to a .3d file in the selected output format (see write_mesh).
+     *
+     * Empty index, normal or texture coordinate vectors are left out of the file.
+     *
+     * @param filepath Output .3d file path.
+     */
+    void write_model(const std::string &filepath, const std::vector<vector3> &vertices, const std::vector<size_t> &indices, const std::vector<vector3> &normals, const std::vector<vector2> &tex_coords);
 };
 
 class InvalidArgumentsException : public std::exception
@@ -0,0 +1,19 @@
+#ifndef SIMPLIFY_HPP
+#define SIMPLIFY_HPP
+
+#include "generator/shape_generator.hpp"
+
+#include "utils/mesh_simplifier.hpp"
+
+/**
+ * Not a shape: reduces the triangle count of an existing .3d file with quadric error edge collapses.
+ *
+ * Usage: generator simplify <in.3d> <target_ratio> <out.3d>
+ */
+class simplify_tool : public shape_generator
+{
+public:
+    void generate(int argc, char **argv) override;
+};
+
+#endif
@@ -9,6 +9,14 @@ namespace math_utils
 {
     vector3 point_on_bezier(float t, vector3 p0, vector3 p1, vector3 p2, vector3 p3);
     vector3 derivative_on_bezier(float t, vector3 p0, vector3 p1, vector3 p2, vector3 p3);
+
+    /**
+     * Grows a sphere to the smallest one enclosing itself and another.
+     *
+     * @param into Center in xyz and radius in w. A negative radius is an empty sphere, an infinite one encloses everything.
+     * @param sphere Sphere to enclose, same conventions.
+     */
+    void merge_spheres(vector4 &into, const vector4 &sphere);
 }
 
 #endif
\ No newline at end of file
@@ -112,7 +112,7 @@ public:
      *
      * @returns Value at row and column.
      */
-    float get_data_at_point(int row, int column);
+    float get_data_at_point(int row, int column) const;
 
     matrix4x4 operator*(const matrix4x4 &other) const;
     vector3 operator*(const vector3 &vec) const; // i think this is unused, anyway, this is the same as multiplying by a vec4 with w = 1
@@ -0,0 +1,58 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+#include <cstddef>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/**
+ * Read-only memory mapping of a whole file.
+ *
+ * The mapping is released when the object is destroyed, so pointers returned by data() must not outlive it.
+ */
+class mapped_file
+{
+public:
+    mapped_file() = default;
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    mapped_file(mapped_file &&other) noexcept;
+    mapped_file &operator=(mapped_file &&other) noexcept;
+
+    /**
+     * Maps a file into memory. Any previous mapping is closed first.
+     *
+     * @param filepath Path to the file to map.
+     *
+     * @returns True if the file was mapped, false if it couldn't be opened or is empty.
+     */
+    bool open(const std::string &filepath);
+
+    /**
+     * Unmaps the file. Safe to call if nothing is mapped.
+     */
+    void close();
+
+    bool is_open() const { return mapped_data != nullptr; }
+    const unsigned char *data() const { return mapped_data; }
+    size_t size() const { return mapped_size; }
+
+private:
+    const unsigned char *mapped_data = nullptr;
+    size_t mapped_size = 0;
+
+#ifdef _WIN32
+    HANDLE file_handle = INVALID_HANDLE_VALUE;
+    HANDLE mapping_handle = NULL;
+#endif
+
+    void steal(mapped_file &other);
+};
+
+#endif
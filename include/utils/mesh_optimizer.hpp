@@ -0,0 +1,73 @@
+#ifndef MESH_OPTIMIZER_HPP
+#define MESH_OPTIMIZER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "utils/model_file.hpp"
+
+#define VERTEX_CACHE_SIZE 32       // < -- LRU cache size the triangle reordering optimizes for
+#define ACMR_FIFO_CACHE_SIZE 16    // < -- FIFO cache size used to measure ACMR, close to what real hardware does
+#define WELD_TOLERANCE 1e-5f       // < -- attributes closer than this are considered equal when welding
+
+/**
+ * Offline mesh optimizations, run by the generator before writing .3d files.
+ */
+namespace mesh_optimizer
+{
+    /**
+     * Merges vertices whose position, normal and texture coordinate are all equal within a tolerance, and remaps
+     * the indices to the merged vertices. Unindexed meshes get an index buffer.
+     *
+     * Attributes are snapped to a grid of the tolerance's size and hashed, so this runs in linear time.
+     * Vertices straddling a grid cell border may be left unmerged.
+     *
+     * @param data Mesh to weld.
+     * @param tolerance Grid size attributes are snapped to.
+     *
+     * @returns Number of vertices removed.
+     */
+    size_t weld(mesh_data &data, float tolerance = WELD_TOLERANCE);
+
+    /**
+     * Simulates a FIFO post-transform vertex cache over a triangle list.
+     *
+     * @param indices Triangle list indices.
+     * @param vertex_count Number of vertices the indices refer to.
+     * @param cache_size Number of entries in the simulated cache.
+     *
+     * @returns Average cache miss ratio: transformed vertices per triangle (0.5 is ideal, 3 is worst).
+     */
+    float compute_acmr(const std::vector<uint32_t> &indices, size_t vertex_count, size_t cache_size = ACMR_FIFO_CACHE_SIZE);
+
+    /**
+     * Reorders triangles to improve post-transform vertex cache hits (Tom Forsyth's linear-speed algorithm).
+     *
+     * @param indices Triangle list indices, reordered in place.
+     * @param vertex_count Number of vertices the indices refer to.
+     */
+    void optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count);
+
+    /**
+     * Reorders vertices in the order the index buffer first uses them, so vertex fetches walk memory linearly.
+     * Vertices that aren't referenced by any triangle are dropped. Run after optimize_vertex_cache.
+     *
+     * @param data Mesh to reorder. Every vertex attribute and the indices are rewritten.
+     */
+    void optimize_vertex_fetch(mesh_data &data);
+
+    /**
+     * Runs optimize_vertex_cache (keeping the original order if it was already better) then optimize_vertex_fetch.
+     * Meshes without indices are left untouched, weld them first to get an index buffer.
+     *
+     * @param data Mesh to optimize.
+     * @param acmr_before Filled with the ACMR before optimizing.
+     * @param acmr_after Filled with the ACMR after optimizing.
+     *
+     * @returns True if the mesh was indexed (and so could be optimized).
+     */
+    bool optimize(mesh_data &data, float &acmr_before, float &acmr_after);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef MESH_SIMPLIFIER_HPP
+#define MESH_SIMPLIFIER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "utils/model_file.hpp"
+
+#define SIMPLIFY_MIN_NORMAL_DOT 0.2f // < -- collapses that turn a triangle further than this (cosine) are rejected
+
+/**
+ * Garland-Heckbert quadric error simplification.
+ *
+ * Edges are collapsed onto one of their endpoints (half-edge collapse), cheapest first, so every surviving vertex keeps its
+ * own position, normal and uv. Vertices on uv or normal seams and on open boundaries are never moved, which keeps seams
+ * and silhouettes intact.
+ */
+namespace mesh_simplifier
+{
+    /**
+     * Simplifies an indexed mesh in place. Vertices left unreferenced are dropped.
+     *
+     * @param data Mesh to simplify. Must be indexed (see mesh_optimizer::weld).
+     * @param target_ratio Fraction of the triangles to keep, in (0, 1].
+     *
+     * @returns Number of triangles left. Can stay above the target if every remaining collapse would break the mesh.
+     */
+    size_t simplify(mesh_data &data, float target_ratio);
+
+    /**
+     * Approximates the symmetric Hausdorff distance between two meshes by measuring every vertex of each against the
+     * other's surface.
+     *
+     * @returns Largest distance found.
+     */
+    float hausdorff_distance(const mesh_data &a, const mesh_data &b);
+}
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef MODEL_FILE_HPP
+#define MODEL_FILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "math/vector3.hpp"
+#include "math/vector4.hpp"
+
+// binary .3d layout:
+//  model_file_header, then every present array starting at an offset aligned to MODEL_FILE_ALIGNMENT.
+//  meshes with both normals and texture coordinates store a single interleaved vertex array instead
+//  (MODEL_FLAG_INTERLEAVED), with normals_offset and tex_coords_offset left at 0.
+//  meshes with at most MODEL_SHORT_INDEX_LIMIT vertices store uint16 indices (MODEL_FLAG_SHORT_INDICES).
+//  quantized files (MODEL_FLAG_QUANTIZED) store one interleaved array of compact vertices instead:
+//      int16 position xyz + padding, snorm16 relative to the header's quantization box
+//      uint32 normal, GL_INT_2_10_10_10_REV (if MODEL_FLAG_NORMALS)
+//      half uv (if MODEL_FLAG_TEXTURE_COORDINATES)
+//  all values are little endian.
+
+#define MODEL_FILE_MAGIC "3DBN"
+#define MODEL_FILE_VERSION 5
+#define MODEL_FILE_ALIGNMENT 16
+
+#define MODEL_INTERLEAVED_STRIDE 8    // < -- floats per interleaved vertex: position xyz, normal xyz, uv
+#define MODEL_SHORT_INDEX_LIMIT 65536 // < -- meshes with up to this many vertices can be indexed with uint16
+
+#define MODEL_FLAG_INDICES (1u << 0)             // < -- index array present, uint32 unless MODEL_FLAG_SHORT_INDICES is set
+#define MODEL_FLAG_NORMALS (1u << 1)             // < -- float xyz normal array present
+#define MODEL_FLAG_TEXTURE_COORDINATES (1u << 2) // < -- float uv array present
+#define MODEL_FLAG_INTERLEAVED (1u << 3)         // < -- vertices_offset holds MODEL_INTERLEAVED_STRIDE floats per vertex
+#define MODEL_FLAG_SHORT_INDICES (1u << 4)       // < -- index array is uint16
+#define MODEL_FLAG_QUANTIZED (1u << 5)           // < -- vertices_offset holds compact vertices, see model_file::quantized_stride
+
+struct model_file_header
+{
+    char magic[4];            // < -- always MODEL_FILE_MAGIC, used to tell binary from text files
+    uint32_t version;         // < -- MODEL_FILE_VERSION the file was written with
+    uint32_t flags;           // < -- MODEL_FLAG_* bits
+    uint32_t reserved;        // < -- keeps the following fields 16 byte aligned
+    float bounding_sphere[4]; // < -- center xyz and radius
+
+    uint64_t vertex_count; // < -- number of vertices (not floats!)
+    uint64_t index_count;  // < -- number of indices, 0 if not indexed
+
+    uint64_t vertices_offset;   // < -- byte offsets from the start of the file, 0 if absent
+    uint64_t indices_offset;
+    uint64_t normals_offset;
+    uint64_t tex_coords_offset;
+
+    float quantization[4]; // < -- quantized files: position = xyz + snorm16 * w
+
+    float aabb_min[4]; // < -- axis aligned bounding box corners, w unused
+    float aabb_max[4];
+};
+
+static_assert(sizeof(model_file_header) == 128, "model_file_header must match the on-disk layout");
+
+/**
+ * CPU-side copy of everything stored in a .3d file.
+ */
+struct mesh_data
+{
+    vector4 bounding_sphere; // < -- center xyz and radius
+    vector3 aabb_min;        // < -- axis aligned bounding box corners
+    vector3 aabb_max;
+
+    std::vector<float> vertices;       // < -- xyz per vertex
+    std::vector<uint32_t> indices;     // < -- empty if the mesh isn't indexed
+    std::vector<float> normals;        // < -- xyz per vertex, empty if absent
+    std::vector<float> tex_coords;     // < -- uv per vertex, empty if absent
+
+    size_t vertex_count() const { return vertices.size() / 3; }
+    bool has_indices() const { return !indices.empty(); }
+    bool has_normals() const { return !normals.empty(); }
+    bool has_tex_coords() const { return !tex_coords.empty(); }
+
+    /**
+     * Checks if the mesh has every attribute, which is what the interleaved layout needs.
+     */
+    bool can_interleave() const { return has_normals() && has_tex_coords(); }
+
+    /**
+     * Checks if every index fits in 16 bits.
+     */
+    bool can_use_short_indices() const { return vertex_count() <= MODEL_SHORT_INDEX_LIMIT; }
+};
+
+namespace model_file
+{
+    enum format
+    {
+        FORMAT_TEXT,
+        FORMAT_BINARY,
+        FORMAT_QUANTIZED // < -- binary with compact vertex attributes
+    };
+
+    /**
+     * Size of a compact vertex in a quantized file.
+     *
+     * @param flags MODEL_FLAG_* bits of the file.
+     *
+     * @returns Size in bytes.
+     */
+    inline size_t quantized_stride(uint32_t flags)
+    {
+        return 4 * sizeof(int16_t) + ((flags & MODEL_FLAG_NORMALS) ? sizeof(uint32_t) : 0) + ((flags & MODEL_FLAG_TEXTURE_COORDINATES) ? 2 * sizeof(uint16_t) : 0);
+    }
+
+    /**
+     * Checks if a buffer holds a binary .3d file.
+     *
+     * @returns True if the buffer starts with MODEL_FILE_MAGIC.
+     */
+    bool is_binary(const unsigned char *data, size_t size);
+
+    /**
+     * Validates a binary .3d file in memory: magic, version, and that every array lies inside the buffer.
+     *
+     * @param data Start of the file.
+     * @param size Size of the file in bytes.
+     * @param error Filled with a description of the problem when validation fails.
+     *
+     * @returns Pointer to the header inside data, or nullptr if the file is invalid.
+     */
+    const model_file_header *read_binary_header(const unsigned char *data, size_t size, std::string &error);
+
+    /**
+     * Checks that every index of a binary .3d file refers to one of its vertices. Not part of read_binary_header since it
+     * touches the whole index section.
+     *
+     * @param header Header returned by read_binary_header for data.
+     * @param data Start of the file.
+     * @param error Filled with a description of the problem when an index is out of range.
+     *
+     * @returns False if an index is out of range.
+     */
+    bool check_binary_indices(const model_file_header *header, const unsigned char *data, std::string &error);
+
+    /**
+     * Parses a text .3d file held in memory.
+     *
+     * The buffer is scanned in place with std::from_chars (no locale, no per-token allocations),
+     * and each array is reserved up front from its delimiter count.
+     *
+     * @param data Start of the file contents. Doesn't need to be null terminated.
+     * @param size Size of the file in bytes.
+     * @param out Filled with the parsed mesh.
+     * @param error Filled with a description of the problem when parsing fails.
+     *
+     * @returns True if the file was parsed.
+     */
+    bool parse_text(const char *data, size_t size, mesh_data &out, std::string &error);
+
+    /**
+     * Reads a .3d file of either format into planar arrays with 32-bit indices.
+     * Meant for tools, the engine uploads binary files straight from the mapping instead.
+     *
+     * @param filepath Path to .3d file.
+     * @param out Filled with the mesh.
+     * @param error Filled with a description of the problem when reading fails.
+     *
+     * @returns True if the file was read.
+     */
+    bool read(const std::string &filepath, mesh_data &out, std::string &error);
+
+    /**
+     * Same as read for a binary .3d file already in memory. Compact vertices are dequantized back to floats.
+     *
+     * @param data Start of the file.
+     * @param size Size of the file in bytes.
+     */
+    bool read_binary(const unsigned char *data, size_t size, mesh_data &out, std::string &error);
+
+    /**
+     * Computes tight bounds for a mesh's vertices: a near-minimal bounding sphere (Ritter's, or the box's circumsphere
+     * when that one is smaller) and the axis aligned bounding box.
+     *
+     * @param data Mesh whose bounding_sphere, aabb_min and aabb_max are filled in.
+     */
+    void compute_bounds(mesh_data &data);
+
+    /**
+     * Packs planar position, normal and uv arrays into one interleaved array (MODEL_INTERLEAVED_STRIDE floats per vertex).
+     *
+     * @param vertices xyz per vertex.
+     * @param normals xyz per vertex.
+     * @param tex_coords uv per vertex.
+     * @param vertex_count Number of vertices in each array.
+     * @param out Filled with the interleaved vertices.
+     */
+    void interleave(const float *vertices, const float *normals, const float *tex_coords, size_t vertex_count, std::vector<float> &out);
+
+    /**
+     * Narrows indices to 16 bits. Every index must be below MODEL_SHORT_INDEX_LIMIT.
+     *
+     * @param indices Indices to narrow.
+     * @param out Filled with the narrowed indices.
+     */
+    void narrow_indices(const std::vector<uint32_t> &indices, std::vector<uint16_t> &out);
+
+    /**
+     * Writes a mesh in the text format (one line of ';' separated values per array).
+     *
+     * @returns False if the file couldn't be opened.
+     */
+    bool write_text(const std::string &filepath, const mesh_data &data);
+
+    /**
+     * Writes a mesh in the binary format. Meshes with normals and texture coordinates are written interleaved,
+     * and small meshes get 16-bit indices.
+     *
+     * @param quantize Write compact vertices: 16-bit positions, 2_10_10_10 normals and half uvs.
+     *
+     * @returns False if the file couldn't be opened.
+     */
+    bool write_binary(const std::string &filepath, const mesh_data &data, bool quantize = false);
+
+    /**
+     * Writes a mesh in the given format.
+     *
+     * @returns False if the file couldn't be opened.
+     */
+    bool write(const std::string &filepath, const mesh_data &data, format output_format);
+}
+
+#endif
@@ -74,6 +74,7 @@ namespace printer
                 std::cout << "Press 6 to toggle view frustum rendering." << std::endl;
                 std::cout << "Press 7 to toggle view frustum culling." << std::endl;
                 std::cout << "Press 8 to toggle frustum update on free camera mode." << std::endl;
+                std::cout << "Press 9 to toggle mesh LOD selection (triangles per frame are shown in the window title)." << std::endl;
 
                 std::cout << "\n\n> ! - - - - - Keyboard / mouse controls - - - - - ! <\n"
                           << std::endl;
@@ -0,0 +1,136 @@
+#ifndef QUANTIZATION_HPP
+#define QUANTIZATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Encoders and decoders for the compact vertex formats used by quantized .3d files.
+ */
+namespace quantization
+{
+    /**
+     * Maps a value in [-1, 1] to a signed 16 bit integer.
+     */
+    inline int16_t encode_snorm16(float value)
+    {
+        if (!std::isfinite(value))
+            return 0;
+        return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+    }
+
+    inline float decode_snorm16(int16_t value)
+    {
+        return std::max(value / 32767.0f, -1.0f);
+    }
+
+    /**
+     * Packs a unit normal into GL_INT_2_10_10_10_REV layout: x in the low 10 bits, then y, then z, w left at 0.
+     * Non finite normals (degenerate triangles) are packed as zero.
+     */
+    inline uint32_t encode_normal_2_10_10_10(float x, float y, float z)
+    {
+        float components[3] = {x, y, z};
+        uint32_t packed = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            float c = std::isfinite(components[i]) ? std::clamp(components[i], -1.0f, 1.0f) : 0.0f;
+            int32_t value = (int32_t)std::lround(c * 511.0f);
+            packed |= ((uint32_t)value & 0x3FF) << (i * 10);
+        }
+        return packed;
+    }
+
+    inline void decode_normal_2_10_10_10(uint32_t packed, float &x, float &y, float &z)
+    {
+        float components[3];
+        for (int i = 0; i < 3; i++)
+        {
+            int32_t value = (packed >> (i * 10)) & 0x3FF;
+            if (value & 0x200)
+                value -= 0x400; // sign extend
+            components[i] = std::max(value / 511.0f, -1.0f);
+        }
+        x = components[0];
+        y = components[1];
+        z = components[2];
+    }
+
+    /**
+     * Converts a float to IEEE half precision, rounding to nearest even. Out of range values become infinity.
+     */
+    inline uint16_t encode_half(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16) & 0x8000;
+        int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        if (((bits >> 23) & 0xFF) == 0xFF) // inf or nan
+            return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+        if (exponent >= 31)
+            return (uint16_t)(sign | 0x7C00);
+
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+                return (uint16_t)sign; // too small, flush to zero
+
+            // subnormal half
+            mantissa |= 0x800000;
+            uint32_t shift = (uint32_t)(14 - exponent);
+            uint32_t half_mantissa = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half_mantissa & 1)))
+                half_mantissa++;
+            return (uint16_t)(sign | half_mantissa);
+        }
+
+        uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+            half++; // a carry into the exponent is still the correctly rounded value
+        return (uint16_t)half;
+    }
+
+    inline float decode_half(uint16_t half)
+    {
+        uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+        uint32_t exponent = (half >> 10) & 0x1F;
+        uint32_t mantissa = half & 0x3FF;
+        uint32_t bits;
+
+        if (exponent == 0)
+        {
+            if (mantissa == 0)
+                bits = sign;
+            else
+            {
+                // renormalize subnormal
+                exponent = 127 - 15 + 1;
+                while (!(mantissa & 0x400))
+                {
+                    mantissa <<= 1;
+                    exponent--;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+            }
+        }
+        else if (exponent == 31)
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        else
+            bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef SCENE_PACK_HPP
+#define SCENE_PACK_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/mapped_file.hpp"
+
+// .pack layout:
+//  scene_pack_header, then entry_count scene_pack_entry records, then the name table (names back to back, not null
+//  terminated), then every blob starting at an offset aligned to SCENE_PACK_ALIGNMENT.
+//  entry 0 is always the scene's XML config, the rest are the meshes and textures it references, named exactly as
+//  written in the config's file attributes.
+//  all values are little endian.
+
+#define SCENE_PACK_MAGIC "3DPK"
+#define SCENE_PACK_VERSION 1
+#define SCENE_PACK_ALIGNMENT 64 // < -- multiple of MODEL_FILE_ALIGNMENT, so packed binary .3d files can be used in place
+
+struct scene_pack_header
+{
+    char magic[4];        // < -- always SCENE_PACK_MAGIC
+    uint32_t version;     // < -- SCENE_PACK_VERSION the file was written with
+    uint32_t entry_count; // < -- number of scene_pack_entry records right after the header
+    uint32_t reserved;
+
+    uint64_t names_offset; // < -- byte offset of the name table from the start of the file
+    uint64_t names_size;   // < -- size of the name table in bytes
+};
+
+struct scene_pack_entry
+{
+    uint64_t offset;      // < -- byte offset of the blob from the start of the file
+    uint64_t size;        // < -- size of the blob in bytes
+    uint32_t name_offset; // < -- byte offset of the name inside the name table
+    uint32_t name_length;
+};
+
+static_assert(sizeof(scene_pack_header) == 32, "scene_pack_header must match the on-disk layout");
+static_assert(sizeof(scene_pack_entry) == 24, "scene_pack_entry must match the on-disk layout");
+
+/**
+ * File to store in a pack, and the name it's looked up by.
+ */
+struct scene_pack_source
+{
+    std::string name;
+    std::string filepath;
+};
+
+/**
+ * Read-only view of a .pack file: a scene config plus every asset it needs, behind a single memory mapping.
+ *
+ * Pointers returned by find() point into the mapping, so they stay valid for as long as the pack is open.
+ */
+class scene_pack
+{
+public:
+    scene_pack() = default;
+
+    scene_pack(const scene_pack &) = delete;
+    scene_pack &operator=(const scene_pack &) = delete;
+
+    /**
+     * Checks if a file is a pack by looking at its magic number.
+     *
+     * @param filepath Path to the file.
+     *
+     * @returns True if the file starts with SCENE_PACK_MAGIC.
+     */
+    static bool is_pack(const std::string &filepath);
+
+    /**
+     * Maps a pack and validates its header and table of contents.
+     *
+     * @param filepath Path to .pack file.
+     * @param error Filled with a description of the problem when opening fails.
+     *
+     * @returns True if the pack was opened.
+     */
+    bool open(const std::string &filepath, std::string &error);
+
+    /**
+     * Looks up an entry by name.
+     *
+     * @param name Entry name, as written in the config.
+     * @param data Filled with a pointer to the entry's contents.
+     * @param size Filled with the size of the entry in bytes.
+     *
+     * @returns True if the pack has the entry.
+     */
+    bool find(const std::string &name, const unsigned char *&data, size_t &size) const;
+
+    /**
+     * Getters for the scene config (entry 0).
+     */
+    const char *get_config_data() const { return reinterpret_cast<const char *>(file.data() + entries[0].offset); }
+    size_t get_config_size() const { return entries[0].size; }
+
+    size_t get_entry_count() const { return entries.size(); }
+    size_t get_file_size() const { return file.size(); }
+
+    /**
+     * Writes a pack. Sources are stored in the given order, so the config must come first.
+     *
+     * @param filepath Output .pack file path.
+     * @param sources Files to store.
+     * @param error Filled with a description of the problem when writing fails.
+     *
+     * @returns True if the pack was written.
+     */
+    static bool write(const std::string &filepath, const std::vector<scene_pack_source> &sources, std::string &error);
+
+private:
+    mapped_file file;
+    std::vector<scene_pack_entry> entries;
+    std::unordered_map<std::string, size_t> index; // < -- name to position in entries
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef SKYLINE_PACKER_HPP
+#define SKYLINE_PACKER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Packs rectangles into a fixed size bin with the skyline bottom-left heuristic.
+ *
+ * The bin's filled area is tracked as a skyline: a list of horizontal segments, each the top of everything packed below
+ * it. A rectangle goes where its top edge ends up lowest (ties go to the narrowest fit), and the gaps it leaves under
+ * itself are lost, which is what keeps the structure this simple.
+ */
+class skyline_packer
+{
+public:
+    skyline_packer(uint32_t width, uint32_t height);
+
+    /**
+     * Finds room for a rectangle and marks it as used.
+     *
+     * @param width Rectangle width.
+     * @param height Rectangle height.
+     * @param x Filled with the rectangle's left edge.
+     * @param y Filled with the rectangle's bottom edge.
+     *
+     * @returns False if the rectangle doesn't fit anywhere.
+     */
+    bool insert(uint32_t width, uint32_t height, uint32_t &x, uint32_t &y);
+
+    /**
+     * Fraction of the bin covered by packed rectangles.
+     */
+    float get_occupancy() const { return (float)((double)used_area / ((double)width * height)); }
+
+private:
+    struct segment
+    {
+        uint32_t x;
+        uint32_t y; // < -- height of the skyline over [x, x + width)
+        uint32_t width;
+    };
+
+    uint32_t width;
+    uint32_t height;
+    uint64_t used_area = 0;
+    std::vector<segment> skyline; // < -- sorted by x, covers [0, width)
+
+    /**
+     * Checks if a rectangle fits with its left edge on segment index.
+     *
+     * @param y Filled with the lowest bottom edge the rectangle can have there.
+     */
+    bool fits(size_t index, uint32_t rect_width, uint32_t rect_height, uint32_t &y) const;
+};
+
+#endif
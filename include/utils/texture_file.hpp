@@ -0,0 +1,130 @@
+#ifndef TEXTURE_FILE_HPP
+#define TEXTURE_FILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// .3dt layout (decoded texture cache, written next to the source image):
+//  texture_file_header, then every mip level from the base down to 1x1, each starting at an offset aligned to
+//  TEXTURE_FILE_ALIGNMENT. levels are tightly packed RGBA8 rows, bottom row first like the image DevIL decodes.
+//  the header records the source image's size, modification time and hash, so a stale cache is detected and rebuilt.
+//  all values are little endian.
+
+#define TEXTURE_FILE_MAGIC "3DTX"
+#define TEXTURE_FILE_VERSION 1
+#define TEXTURE_FILE_ALIGNMENT 16
+#define TEXTURE_FILE_EXTENSION ".3dt"
+#define TEXTURE_FILE_MAX_LEVELS 16 // < -- enough for a 32768x32768 base level
+
+#define TEXTURE_FORMAT_RGBA8 1
+
+struct texture_file_level
+{
+    uint64_t offset; // < -- byte offset from the start of the file
+    uint32_t width;
+    uint32_t height;
+};
+
+struct texture_file_header
+{
+    char magic[4];        // < -- always TEXTURE_FILE_MAGIC
+    uint32_t version;     // < -- TEXTURE_FILE_VERSION the file was written with
+    uint32_t width;       // < -- base level size
+    uint32_t height;
+    uint32_t level_count; // < -- number of used entries in levels
+    uint32_t format;      // < -- TEXTURE_FORMAT_*
+    uint32_t reserved[2];
+
+    uint64_t source_size;  // < -- source image size in bytes
+    int64_t source_mtime;  // < -- source image modification time, in file clock ticks
+    uint64_t source_hash;  // < -- FNV-1a of the source image bytes
+    uint64_t reserved_source;
+
+    texture_file_level levels[TEXTURE_FILE_MAX_LEVELS];
+};
+
+static_assert(sizeof(texture_file_header) == 320, "texture_file_header must match the on-disk layout");
+
+/**
+ * Where a texture came from, used to tell if a cache file is still up to date.
+ */
+struct texture_source_info
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0; // < -- only filled in when needed, see texture_file::is_up_to_date
+};
+
+/**
+ * Full RGBA8 mip chain, base level first.
+ */
+struct mip_chain
+{
+    std::vector<unsigned char> pixels; // < -- every level back to back
+    std::vector<texture_file_level> levels; // < -- offsets are into pixels
+};
+
+namespace texture_file
+{
+    /**
+     * Path of the cache file for an image.
+     */
+    inline std::string cache_path(const std::string &image_filepath) { return image_filepath + TEXTURE_FILE_EXTENSION; }
+
+    /**
+     * Reads the size and modification time of a file.
+     *
+     * @returns False if the file doesn't exist.
+     */
+    bool stat_source(const std::string &filepath, texture_source_info &info);
+
+    /**
+     * Hashes a whole file with FNV-1a.
+     *
+     * @returns False if the file couldn't be read.
+     */
+    bool hash_source(const std::string &filepath, uint64_t &hash);
+
+    /**
+     * Validates a cache file in memory: magic, version, format, and that every level lies inside the buffer.
+     *
+     * @param error Filled with a description of the problem when validation fails.
+     *
+     * @returns Pointer to the header inside data, or nullptr if the file is invalid.
+     */
+    const texture_file_header *read_header(const unsigned char *data, size_t size, std::string &error);
+
+    /**
+     * Checks if a cache file was built from the current version of its source image.
+     * Sizes must match. Matching modification times are trusted, otherwise the source is hashed, so touching a file
+     * without changing it doesn't force a rebuild.
+     *
+     * @param header Validated cache header.
+     * @param source_filepath Path to the source image.
+     * @param source Filled with the source's size and time (and hash, if it was needed).
+     *
+     * @returns True if the cache can be used.
+     */
+    bool is_up_to_date(const texture_file_header &header, const std::string &source_filepath, texture_source_info &source);
+
+    /**
+     * Builds the mip chain of an RGBA8 image with a 2x2 box filter, down to 1x1.
+     *
+     * @param pixels Base level, tightly packed.
+     * @param width Base level width.
+     * @param height Base level height.
+     * @param out Filled with every level, the base one included.
+     */
+    void build_mip_chain(const unsigned char *pixels, uint32_t width, uint32_t height, mip_chain &out);
+
+    /**
+     * Writes a cache file.
+     *
+     * @returns False if the file couldn't be written.
+     */
+    bool write(const std::string &filepath, const mip_chain &chain, const texture_source_info &source);
+}
+
+#endif
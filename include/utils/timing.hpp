@@ -0,0 +1,35 @@
+#ifndef TIMING_HPP
+#define TIMING_HPP
+
+#include <chrono>
+#include <functional>
+
+/**
+ * Timing helpers shared by the engine's and the generator's benchmarks.
+ */
+namespace timing
+{
+    /**
+     * Runs a function repeatedly for at least min_seconds (and at least 3 times).
+     *
+     * @returns Average seconds per run.
+     */
+    inline double time_runs(const std::function<void()> &run, double min_seconds = 0.25)
+    {
+        using clock = std::chrono::steady_clock;
+
+        int runs = 0;
+        double elapsed = 0;
+        clock::time_point start = clock::now();
+        while (runs < 3 || elapsed < min_seconds)
+        {
+            run();
+            runs++;
+            elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        }
+
+        return elapsed / runs;
+    }
+}
+
+#endif
@@ -4,9 +4,19 @@ setlocal
 set "SUBFOLDER=bin"
 set "EXECUTABLE=generator.exe"
 
-set "SPHERE_ARGS=sphere 1 100 100 sphere.3d"
-set "TORUS_ARGS=torus 1.0 1.25 100 100 torus.3d"
-set "PATCH_ARGS=patch teapot.patch 20 patch.3d"
+set "SPHERE_ARGS=--binary sphere 1 100 100 sphere.3d"
+set "TORUS_ARGS=--binary torus 1.0 1.25 100 100 torus.3d"
+set "PATCH_ARGS=--binary patch teapot.patch 20 patch.3d"
+
+:: coarser levels of detail, picked by the engine when models get small on screen
+set "SPHERE_LOD1_ARGS=--binary sphere 1 48 48 sphere_lod1.3d"
+set "SPHERE_LOD2_ARGS=--binary sphere 1 24 24 sphere_lod2.3d"
+set "SPHERE_LOD3_ARGS=--binary sphere 1 10 10 sphere_lod3.3d"
+set "TORUS_LOD1_ARGS=--binary torus 1.0 1.25 48 48 torus_lod1.3d"
+set "TORUS_LOD2_ARGS=--binary torus 1.0 1.25 24 24 torus_lod2.3d"
+set "TORUS_LOD3_ARGS=--binary torus 1.0 1.25 12 12 torus_lod3.3d"
+set "PATCH_LOD1_ARGS=--binary patch teapot.patch 8 patch_lod1.3d"
+set "PATCH_LOD2_ARGS=--binary patch teapot.patch 3 patch_lod2.3d"
 
 :: generate sphere
 "%CD%\%SUBFOLDER%\%EXECUTABLE%" %SPHERE_ARGS%
@@ -17,4 +27,17 @@ set "PATCH_ARGS=patch teapot.patch 20 patch.3d"
 :: generate patch 
 "%CD%\%SUBFOLDER%\%EXECUTABLE%" %PATCH_ARGS%
 
-endlocal
\ No newline at end of file
+:: generate levels of detail
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %SPHERE_LOD1_ARGS%
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %SPHERE_LOD2_ARGS%
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %SPHERE_LOD3_ARGS%
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %TORUS_LOD1_ARGS%
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %TORUS_LOD2_ARGS%
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %TORUS_LOD3_ARGS%
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %PATCH_LOD1_ARGS%
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" %PATCH_LOD2_ARGS%
+
+:: bundle the scene into a single file, run the engine with solar_system.pack instead of the xml
+"%CD%\%SUBFOLDER%\%EXECUTABLE%" pack config\config_solar_system.xml solar_system.pack
+
+endlocal
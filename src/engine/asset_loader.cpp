@@ -0,0 +1,107 @@
+#include "engine/asset_loader.hpp"
+#include "engine/mesh_cache.hpp"
+#include "engine/texture_cache.hpp"
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    std::mutex uploads_mutex;
+    std::queue<std::function<void()>> uploads;
+
+    std::atomic<size_t> pending(0); // < -- jobs not finished + uploads not run
+
+    std::shared_ptr<scene_pack> mounted; // < -- set once before loading starts, read-only afterwards
+
+    bool reported = true;
+    clock::time_point load_start;
+
+    thread_pool &workers()
+    {
+        // leave a core for the GL thread
+        static thread_pool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+        return pool;
+    }
+}
+
+void asset_loader::submit(std::function<void()> job)
+{
+    if (reported)
+    {
+        reported = false;
+        load_start = clock::now();
+    }
+
+    pending++;
+    workers().submit([job]() {
+        job();
+        pending--;
+    });
+}
+
+void asset_loader::queue_upload(std::function<void()> upload)
+{
+    pending++;
+
+    std::lock_guard<std::mutex> lock(uploads_mutex);
+    uploads.push(std::move(upload));
+}
+
+void asset_loader::process_uploads(int budget_ms)
+{
+    clock::time_point start = clock::now();
+
+    while (true)
+    {
+        std::function<void()> upload;
+        {
+            std::lock_guard<std::mutex> lock(uploads_mutex);
+            if (uploads.empty())
+                break;
+
+            upload = std::move(uploads.front());
+            uploads.pop();
+        }
+
+        upload();
+        pending--;
+
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count() >= budget_ms)
+            break;
+    }
+
+    if (!reported && pending == 0)
+    {
+        reported = true;
+
+        std::stringstream ss;
+        ss << "All assets resident after " << std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - load_start).count()
+           << " ms using " << workers().get_thread_count() << " worker thread(s).";
+        printer::print_info(ss.str(), "asset_loader");
+
+        mesh_cache::print_stats();
+        texture_cache::print_stats();
+    }
+}
+
+bool asset_loader::is_loading()
+{
+    return pending != 0;
+}
+
+void asset_loader::mount_pack(std::shared_ptr<scene_pack> pack)
+{
+    mounted = std::move(pack);
+}
+
+bool asset_loader::find_packed(const std::string &filepath, const unsigned char *&data, size_t &size)
+{
+    if (!mounted)
+        return false;
+
+    if (mounted->find(filepath, data, size))
+        return true;
+
+    printer::print_warning(filepath + " isn't in the mounted pack, reading it from disk.", "asset_loader");
+    return false;
+}
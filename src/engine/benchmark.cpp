@@ -0,0 +1,459 @@
+#include "engine/benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define BENCHMARK_SCENE_GROUPS 100000
+#define BENCHMARK_SCENE_BRANCHING 4 // < -- children per group
+#define BENCHMARK_BVH_QUERIES 1000    // < -- rays and spheres timed per object count
+#define BENCHMARK_BVH_CHECKED 20      // < -- of those, checked against every box
+#define BENCHMARK_BVH_DRIFT_FRAMES 60
+#define BENCHMARK_CULL_SPHERES 1000000
+#define BENCHMARK_STEP_MS 16   // < -- frame time the parallel update is checked with
+#define BENCHMARK_STEPS 10
+
+namespace
+{
+    // group i is a child of group (i - 1) / BENCHMARK_SCENE_BRANCHING, every one of them translated, rotated and scaled.
+    // one group in animated_every spins, the rest are static
+    tinyxml2::XMLElement *synthetic_scene(tinyxml2::XMLDocument &doc, size_t group_count, size_t animated_every)
+    {
+        std::vector<tinyxml2::XMLElement *> elements(group_count);
+        for (size_t i = 0; i < group_count; i++)
+        {
+            tinyxml2::XMLElement *element = doc.NewElement("group");
+            tinyxml2::XMLElement *transform = element->InsertNewChildElement("transform");
+
+            tinyxml2::XMLElement *translate = transform->InsertNewChildElement("translate");
+            translate->SetAttribute("x", (float)(i % 7) + 1.0f);
+            translate->SetAttribute("y", 0.0f);
+            translate->SetAttribute("z", (float)(i % 3));
+
+            tinyxml2::XMLElement *rotate = transform->InsertNewChildElement("rotate");
+            if (i % animated_every == animated_every - 1)
+                rotate->SetAttribute("time", 5.0f + (float)(i % 11));
+            else
+                rotate->SetAttribute("angle", (float)(i % 360));
+            rotate->SetAttribute("x", 0.0f);
+            rotate->SetAttribute("y", 1.0f);
+            rotate->SetAttribute("z", 0.0f);
+
+            tinyxml2::XMLElement *scale = transform->InsertNewChildElement("scale");
+            scale->SetAttribute("x", 0.9f);
+            scale->SetAttribute("y", 0.9f);
+            scale->SetAttribute("z", 0.9f);
+
+            elements[i] = element;
+            if (i == 0)
+                doc.InsertEndChild(element);
+            else
+                elements[(i - 1) / BENCHMARK_SCENE_BRANCHING]->InsertEndChild(element);
+        }
+
+        return elements[0];
+    }
+
+    // times both updates of one scene and prints a row, returns false if their positions differ
+    bool compare_updates(const std::string &label, size_t group_count, size_t animated_every)
+    {
+        tinyxml2::XMLDocument doc;
+        std::vector<group> roots;
+        roots.push_back(group(synthetic_scene(doc, group_count, animated_every)));
+
+        // both share the same transform objects, so only dt = 0 keeps their animations in step
+        scene_graph flattened(roots);
+
+        double recursive_seconds = timing::time_runs([&roots]() { roots[0].update_group(0, matrix4x4::Identity()); });
+        double flattened_seconds = timing::time_runs([&flattened]() { flattened.update(0); });
+
+        std::vector<vector3> recursive_positions = roots[0].query_group_positions();
+        std::vector<vector3> flattened_positions = flattened.query_positions();
+
+        float max_difference = 0.0f;
+        for (size_t i = 0; i < recursive_positions.size() && i < flattened_positions.size(); i++)
+        {
+            vector3 difference = recursive_positions[i] - flattened_positions[i];
+            max_difference = std::max(max_difference, std::max(std::abs(difference.x), std::max(std::abs(difference.y), std::abs(difference.z))));
+        }
+        bool matches = recursive_positions.size() == flattened_positions.size() && max_difference == 0.0f;
+
+        std::cout << std::left << std::setw(20) << label << std::right << std::setw(10) << flattened.get_moving_count()
+                  << std::fixed << std::setprecision(3) << std::setw(16) << recursive_seconds * 1e3 << std::setw(16) << flattened_seconds * 1e3
+                  << std::setprecision(1) << std::setw(10) << recursive_seconds / flattened_seconds << "x"
+                  << (matches ? "" : "  POSITIONS DIFFER") << std::defaultfloat << "\n";
+
+        return matches;
+    }
+
+    float random_float(std::mt19937 &rng, float low, float high)
+    {
+        return std::uniform_real_distribution<float>(low, high)(rng);
+    }
+
+    // boxes 1 to 3 units wide in a cube sized so the density is the same at every count
+    std::vector<bvh_box> random_boxes(size_t count, float side, std::mt19937 &rng)
+    {
+        std::vector<bvh_box> boxes(count);
+        for (bvh_box &box : boxes)
+        {
+            vector3 center(random_float(rng, 0.0f, side), random_float(rng, 0.0f, side), random_float(rng, 0.0f, side));
+            vector3 half(random_float(rng, 0.5f, 1.5f), random_float(rng, 0.5f, 1.5f), random_float(rng, 0.5f, 1.5f));
+            box = {center - half, center + half};
+        }
+        return boxes;
+    }
+
+    // reference for bvh::raycast, the nearest box entered along the ray found by testing every box
+    float nearest_entry(const std::vector<bvh_box> &boxes, const vector3 &origin, const vector3 &direction, float max_distance)
+    {
+        float nearest = -1.0f;
+        for (const bvh_box &box : boxes)
+        {
+            float t_near = 0.0f, t_far = max_distance;
+            float o[3] = {origin.x, origin.y, origin.z}, d[3] = {direction.x, direction.y, direction.z};
+            float low[3] = {box.min.x, box.min.y, box.min.z}, high[3] = {box.max.x, box.max.y, box.max.z};
+            for (int axis = 0; axis < 3 && t_near <= t_far; axis++)
+            {
+                float t0 = (low[axis] - o[axis]) * (1.0f / d[axis]), t1 = (high[axis] - o[axis]) * (1.0f / d[axis]);
+                if (t0 > t1)
+                    std::swap(t0, t1);
+                t_near = t0 > t_near ? t0 : t_near;
+                t_far = t1 < t_far ? t1 : t_far;
+            }
+            if (t_near <= t_far && (nearest < 0.0f || t_near < nearest))
+                nearest = t_near;
+        }
+        return nearest;
+    }
+
+    // times one object count and prints a row, returns false if a query disagrees with testing every box
+    bool measure_bvh(size_t object_count)
+    {
+        std::mt19937 rng(1234);
+        float side = 4.0f * std::cbrt((float)object_count);
+        std::vector<bvh_box> boxes = random_boxes(object_count, side, rng);
+
+        bvh index;
+        double build_seconds = timing::time_runs([&index, &boxes]() { index.build(boxes); });
+        double refit_seconds = timing::time_runs([&index]() { index.refit(); });
+
+        // looking down z from the middle of one face, the far plane at the opposite one
+        frustum view_frustum;
+        matrix4x4 projection_view = matrix4x4::Projection(60.0f, 16.0f / 9.0f, 1.0f, side) *
+                                    matrix4x4::View(vector3(side * 0.5f, side * 0.5f, 0.0f), vector3(side * 0.5f, side * 0.5f, side), vector3(0.0f, 1.0f, 0.0f));
+        view_frustum.update_frustum(projection_view);
+
+        std::vector<bvh_visible> visible;
+        double cull_seconds = timing::time_runs([&index, &view_frustum, &visible]() {
+            visible.clear();
+            index.cull(view_frustum, visible);
+        });
+
+        std::vector<uint32_t> every_box;
+        double brute_seconds = timing::time_runs([&boxes, &view_frustum, &every_box]() {
+            every_box.clear();
+            for (uint32_t i = 0; i < boxes.size(); i++)
+            {
+                unsigned char planes = FRUSTUM_ALL_PLANES;
+                if (view_frustum.cull_box(boxes[i].min, boxes[i].max, planes))
+                    every_box.push_back(i);
+            }
+        });
+
+        std::vector<uint32_t> culled;
+        for (const bvh_visible &item : visible)
+            culled.push_back(item.item);
+        std::sort(culled.begin(), culled.end());
+        bool matches = culled == every_box;
+
+        std::vector<vector3> origins, directions, centers;
+        for (int q = 0; q < BENCHMARK_BVH_QUERIES; q++)
+        {
+            origins.push_back(vector3(random_float(rng, 0.0f, side), random_float(rng, 0.0f, side), random_float(rng, 0.0f, side)));
+            directions.push_back(vector3(random_float(rng, -1.0f, 1.0f), random_float(rng, -1.0f, 1.0f), random_float(rng, -1.0f, 1.0f)));
+            directions.back().normalize();
+            centers.push_back(vector3(random_float(rng, 0.0f, side), random_float(rng, 0.0f, side), random_float(rng, 0.0f, side)));
+        }
+
+        double ray_seconds = timing::time_runs([&index, &origins, &directions, side]() {
+            uint32_t item;
+            float distance;
+            for (int q = 0; q < BENCHMARK_BVH_QUERIES; q++)
+                index.raycast(origins[q], directions[q], side, item, distance);
+        });
+
+        std::vector<uint32_t> found;
+        double sphere_seconds = timing::time_runs([&index, &centers, &found]() {
+            for (int q = 0; q < BENCHMARK_BVH_QUERIES; q++)
+            {
+                found.clear();
+                index.query_sphere(centers[q], 5.0f, found);
+            }
+        });
+
+        for (int q = 0; q < BENCHMARK_BVH_CHECKED; q++)
+        {
+            uint32_t item;
+            float distance;
+            bool hit = index.raycast(origins[q], directions[q], side, item, distance);
+            float expected = nearest_entry(boxes, origins[q], directions[q], side);
+            matches = matches && hit == (expected >= 0.0f) && (!hit || distance == expected);
+
+            found.clear();
+            index.query_sphere(centers[q], 5.0f, found);
+            size_t expected_found = 0;
+            for (const bvh_box &box : boxes)
+            {
+                vector3 closest(std::clamp(centers[q].x, box.min.x, box.max.x), std::clamp(centers[q].y, box.min.y, box.max.y), std::clamp(centers[q].z, box.min.z, box.max.z));
+                vector3 offset = closest - centers[q];
+                expected_found += vector3::dot(offset, offset) <= 25.0f;
+            }
+            matches = matches && found.size() == expected_found;
+        }
+
+        std::cout << std::fixed << std::setw(10) << object_count << std::setprecision(2) << std::setw(12) << build_seconds * 1e3
+                  << std::setw(12) << refit_seconds * 1e3 << std::setw(12) << cull_seconds * 1e3 << std::setw(12) << brute_seconds * 1e3
+                  << std::setw(10) << visible.size() << std::setw(10) << ray_seconds * 1e6 / BENCHMARK_BVH_QUERIES
+                  << std::setw(12) << sphere_seconds * 1e6 / BENCHMARK_BVH_QUERIES << (matches ? "" : "  QUERIES DIFFER") << "\n";
+
+        // every box drifts its own way, refits slowly loosen the tree until subtrees get rebuilt
+        std::vector<vector3> velocities(object_count);
+        for (vector3 &velocity : velocities)
+            velocity = vector3(random_float(rng, -0.5f, 0.5f), random_float(rng, -0.5f, 0.5f), random_float(rng, -0.5f, 0.5f));
+
+        size_t rebuilt = 0;
+        double drift_seconds = 0;
+        for (int frame = 0; frame < BENCHMARK_BVH_DRIFT_FRAMES; frame++)
+        {
+            for (uint32_t i = 0; i < object_count; i++)
+            {
+                bvh_box &box = index.item_bounds(i);
+                box.min += velocities[i];
+                box.max += velocities[i];
+            }
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            rebuilt += index.refit();
+            drift_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        std::vector<bvh_box> drifted(object_count);
+        for (uint32_t i = 0; i < object_count; i++)
+            drifted[i] = index.item_bounds(i);
+        bvh fresh;
+        fresh.build(drifted);
+
+        std::cout << std::setw(10) << "" << "  after " << BENCHMARK_BVH_DRIFT_FRAMES << " frames of drift: " << rebuilt << " subtree(s) rebuilt, "
+                  << std::setprecision(2) << drift_seconds * 1e3 / BENCHMARK_BVH_DRIFT_FRAMES << " ms per refit, sah cost "
+                  << index.get_sah_cost() << " (fresh build " << fresh.get_sah_cost() << ")\n"
+                  << std::defaultfloat;
+
+        return matches;
+    }
+}
+
+int engine_benchmark::run(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printer::print_exception("Missing benchmark name! Available: scene_graph, update_scaling, bvh, cull_kernels", "engine_benchmark");
+        return 1;
+    }
+
+    std::string name(argv[2]);
+    if (name.compare("scene_graph") == 0)
+        return benchmark_scene_graph(argc, argv);
+    if (name.compare("update_scaling") == 0)
+        return benchmark_update_scaling(argc, argv);
+    if (name.compare("bvh") == 0)
+        return benchmark_bvh(argc, argv);
+    if (name.compare("cull_kernels") == 0)
+        return benchmark_cull_kernels(argc, argv);
+
+    printer::print_exception("Unknown benchmark! Available: scene_graph, update_scaling, bvh, cull_kernels", "engine_benchmark");
+    return 1;
+}
+
+int engine_benchmark::benchmark_scene_graph(int argc, char **argv)
+{
+    size_t group_count = argc > 3 ? std::stoul(argv[3]) : BENCHMARK_SCENE_GROUPS;
+    if (group_count == 0)
+    {
+        printer::print_exception("Group count must be larger than 0!", "engine_benchmark");
+        return 1;
+    }
+
+    std::cout << group_count << " groups, " << BENCHMARK_SCENE_BRANCHING << " children each\n"
+              << std::left << std::setw(20) << "scene" << std::right << std::setw(10) << "moving"
+              << std::setw(16) << "recursive ms" << std::setw(16) << "flattened ms" << std::setw(11) << "speedup" << "\n";
+
+    bool matches = compare_updates("all animated", group_count, 1);
+    matches = compare_updates("1% animated", group_count, 100) && matches;
+    matches = compare_updates("static", group_count, group_count + 1) && matches;
+    std::cout << std::flush;
+
+    return matches ? 0 : 1;
+}
+
+int engine_benchmark::benchmark_update_scaling(int argc, char **argv)
+{
+    size_t group_count = argc > 3 ? std::stoul(argv[3]) : BENCHMARK_SCENE_GROUPS;
+    size_t max_threads = argc > 4 ? std::stoul(argv[4]) : std::thread::hardware_concurrency();
+    if (group_count == 0)
+    {
+        printer::print_exception("Group count must be larger than 0!", "engine_benchmark");
+        return 1;
+    }
+    max_threads = std::max<size_t>(max_threads, 1);
+
+    tinyxml2::XMLDocument doc;
+    std::vector<group> roots;
+    roots.push_back(group(synthetic_scene(doc, group_count, 1)));
+    scene_graph scene(roots);
+
+    // a scene of its own, advanced serially, is what every pool has to reproduce
+    tinyxml2::XMLDocument expected_doc;
+    std::vector<group> expected_roots;
+    expected_roots.push_back(group(synthetic_scene(expected_doc, group_count, 1)));
+    scene_graph expected_scene(expected_roots);
+    for (int step = 0; step < BENCHMARK_STEPS; step++)
+        expected_scene.update(BENCHMARK_STEP_MS);
+
+    double serial_seconds = timing::time_runs([&scene]() { scene.update(BENCHMARK_STEP_MS); });
+
+    std::cout << group_count << " groups, all animated, " << scene.get_update_task_count() << " update tasks\n"
+              << std::left << std::setw(12) << "threads" << std::right << std::setw(12) << "ms" << std::setw(11) << "speedup" << "\n"
+              << std::fixed << std::setprecision(3) << std::left << std::setw(12) << "serial" << std::right << std::setw(12) << serial_seconds * 1e3
+              << std::setprecision(2) << std::setw(10) << 1.0 << "x\n";
+
+    bool matches = true;
+    for (size_t threads = 1; threads <= max_threads; threads = threads * 2 > max_threads && threads != max_threads ? max_threads : threads * 2)
+    {
+        work_stealing_pool pool(threads);
+        double seconds = timing::time_runs([&scene, &pool]() { scene.update(BENCHMARK_STEP_MS, pool); });
+
+        // every local matrix changes each step, so a child updated before its parent would pick up a stale world matrix
+        tinyxml2::XMLDocument parallel_doc;
+        std::vector<group> parallel_roots;
+        parallel_roots.push_back(group(synthetic_scene(parallel_doc, group_count, 1)));
+        scene_graph parallel_scene(parallel_roots);
+        for (int step = 0; step < BENCHMARK_STEPS; step++)
+            parallel_scene.update(BENCHMARK_STEP_MS, pool);
+
+        bool identical = true;
+        for (size_t i = 0; i < expected_scene.get_group_count() && identical; i++)
+            identical = std::memcmp((const float *)parallel_scene.get_world_matrix(i), (const float *)expected_scene.get_world_matrix(i), 16 * sizeof(float)) == 0;
+        matches = matches && identical;
+
+        std::cout << std::setprecision(3) << std::left << std::setw(12) << threads << std::right << std::setw(12) << seconds * 1e3
+                  << std::setprecision(2) << std::setw(10) << serial_seconds / seconds << "x" << (identical ? "" : "  MATRICES DIFFER") << "\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+
+    return matches ? 0 : 1;
+}
+
+int engine_benchmark::benchmark_bvh(int argc, char **argv)
+{
+    std::vector<size_t> object_counts = {10000, 100000, 1000000};
+    if (argc > 3)
+        object_counts = {std::stoul(argv[3])};
+    if (object_counts[0] == 0)
+    {
+        printer::print_exception("Object count must be larger than 0!", "engine_benchmark");
+        return 1;
+    }
+
+    std::cout << std::setw(10) << "objects" << std::setw(12) << "build ms" << std::setw(12) << "refit ms" << std::setw(12) << "cull ms"
+              << std::setw(12) << "brute ms" << std::setw(10) << "visible" << std::setw(10) << "ray us" << std::setw(12) << "sphere us" << "\n";
+
+    bool matches = true;
+    for (size_t object_count : object_counts)
+        matches = measure_bvh(object_count) && matches;
+    std::cout << std::flush;
+
+    return matches ? 0 : 1;
+}
+
+int engine_benchmark::benchmark_cull_kernels(int argc, char **argv)
+{
+    size_t sphere_count = argc > 3 ? std::stoul(argv[3]) : BENCHMARK_CULL_SPHERES;
+    if (sphere_count == 0)
+    {
+        printer::print_exception("Sphere count must be larger than 0!", "engine_benchmark");
+        return 1;
+    }
+
+    // same layout as the bvh benchmark: a cube of spheres seen from the middle of one face
+    std::mt19937 rng(1234);
+    float side = 4.0f * std::cbrt((float)sphere_count);
+    std::vector<float> xs(sphere_count), ys(sphere_count), zs(sphere_count), radii(sphere_count);
+    for (size_t i = 0; i < sphere_count; i++)
+    {
+        xs[i] = random_float(rng, 0.0f, side);
+        ys[i] = random_float(rng, 0.0f, side);
+        zs[i] = random_float(rng, 0.0f, side);
+        radii[i] = random_float(rng, 0.5f, 1.5f);
+    }
+
+    frustum view_frustum;
+    matrix4x4 projection_view = matrix4x4::Projection(60.0f, 16.0f / 9.0f, 1.0f, side) *
+                                matrix4x4::View(vector3(side * 0.5f, side * 0.5f, 0.0f), vector3(side * 0.5f, side * 0.5f, side), vector3(0.0f, 1.0f, 0.0f));
+    view_frustum.update_frustum(projection_view);
+
+    unsigned char default_kernel = frustum::cull_kernel;
+    std::vector<unsigned char> expected(sphere_count), planes(sphere_count);
+
+    std::cout << sphere_count << " spheres, " << frustum_kernels::name(default_kernel) << " picked at runtime\n"
+              << std::left << std::setw(12) << "kernel" << std::right << std::setw(12) << "ms" << std::setw(16) << "Mspheres/s"
+              << std::setw(11) << "speedup" << std::setw(10) << "visible" << "\n";
+
+    bool matches = true;
+    double scalar_seconds = 0;
+    unsigned char kernels[3] = {FRUSTUM_KERNEL_SCALAR, FRUSTUM_KERNEL_SSE, FRUSTUM_KERNEL_AVX2};
+    for (unsigned char kernel : kernels)
+    {
+        if (!frustum_kernels::supported(kernel))
+        {
+            std::cout << std::left << std::setw(12) << frustum_kernels::name(kernel) << std::right << std::setw(12) << "unsupported" << "\n";
+            continue;
+        }
+
+        // masks are narrowed in place, every run starts over from all planes like a frame does
+        frustum::cull_kernel = kernel;
+        std::vector<unsigned char> &masks = kernel == FRUSTUM_KERNEL_SCALAR ? expected : planes;
+        double seconds = timing::time_runs([&view_frustum, &xs, &ys, &zs, &radii, &masks]() {
+            std::fill(masks.begin(), masks.end(), (unsigned char)FRUSTUM_ALL_PLANES);
+            view_frustum.cull_spheres(xs.data(), ys.data(), zs.data(), radii.data(), xs.size(), masks.data());
+        });
+        if (kernel == FRUSTUM_KERNEL_SCALAR)
+            scalar_seconds = seconds;
+
+        size_t visible_count = (size_t)std::count_if(masks.begin(), masks.end(), [](unsigned char mask) {
+            return mask != FRUSTUM_CULLED;
+        });
+
+        bool identical = masks == expected;
+        matches = matches && identical;
+
+        std::cout << std::fixed << std::left << std::setw(12) << frustum_kernels::name(kernel) << std::right << std::setprecision(3)
+                  << std::setw(12) << seconds * 1e3 << std::setprecision(1) << std::setw(16) << sphere_count / seconds / 1e6
+                  << std::setprecision(2) << std::setw(10) << scalar_seconds / seconds << "x" << std::setw(10) << visible_count
+                  << (identical ? "" : "  MASKS DIFFER") << "\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+
+    // the scalar fallback has to agree with the one-sphere test the rest of the engine uses, narrowed planes included
+    for (size_t i = 0; i < sphere_count && matches; i++)
+    {
+        unsigned char sphere_planes = FRUSTUM_ALL_PLANES;
+        bool inside = view_frustum.cull_sphere(vector3(xs[i], ys[i], zs[i]), radii[i], sphere_planes);
+        matches = inside ? expected[i] == sphere_planes : expected[i] == FRUSTUM_CULLED;
+    }
+    if (!matches)
+        printer::print_exception("Kernels don't agree with frustum::cull_sphere!", "engine_benchmark");
+
+    frustum::cull_kernel = default_kernel;
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,348 @@
+#include "engine/bvh.hpp"
+
+namespace
+{
+    float component(const vector3 &v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    float centroid(const bvh_box &box, int axis)
+    {
+        return (component(box.min, axis) + component(box.max, axis)) * 0.5f;
+    }
+
+    bvh_box empty_box()
+    {
+        static const float inf = std::numeric_limits<float>::infinity();
+        static const bvh_box empty = {vector3(inf, inf, inf), vector3(-inf, -inf, -inf)};
+        return empty;
+    }
+
+    // distance along the ray where it enters the box, negative if it misses it
+    float ray_entry(const bvh_box &box, const vector3 &origin, const vector3 &inverse_direction, float max_distance)
+    {
+        float t_near = 0.0f, t_far = max_distance;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float o = component(origin, axis), inverse = component(inverse_direction, axis);
+            float t0 = (component(box.min, axis) - o) * inverse;
+            float t1 = (component(box.max, axis) - o) * inverse;
+            if (t0 > t1)
+                std::swap(t0, t1);
+
+            // a ray parallel to the slab and on its edge gives NaN, which keeps the bounds as they were
+            t_near = t0 > t_near ? t0 : t_near;
+            t_far = t1 < t_far ? t1 : t_far;
+            if (t_near > t_far)
+                return -1.0f;
+        }
+
+        return t_near;
+    }
+}
+
+// build
+
+void bvh::build(std::vector<bvh_box> boxes)
+{
+    items = std::move(boxes);
+    nodes.clear();
+    costs.clear();
+    built_costs.clear();
+    if (items.empty())
+        return;
+
+    nodes.resize(items.size() * 2 - 1);
+    costs.resize(nodes.size());
+    built_costs.resize(nodes.size());
+
+    order.resize(items.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    build_node(0, 0, (uint32_t)order.size());
+}
+
+uint32_t bvh::build_node(uint32_t index, uint32_t first, uint32_t last)
+{
+    bvh_box bounds = empty_box(), centroids = empty_box();
+    for (uint32_t k = first; k < last; k++)
+    {
+        const bvh_box &box = items[order[k]];
+        grow(bounds, box);
+
+        float x = centroid(box, 0), y = centroid(box, 1), z = centroid(box, 2);
+        centroids.min.x = std::min(centroids.min.x, x);
+        centroids.min.y = std::min(centroids.min.y, y);
+        centroids.min.z = std::min(centroids.min.z, z);
+        centroids.max.x = std::max(centroids.max.x, x);
+        centroids.max.y = std::max(centroids.max.y, y);
+        centroids.max.z = std::max(centroids.max.z, z);
+    }
+    if (last - first == 1)
+    {
+        nodes[index] = {bounds, index + 1, order[first]};
+        costs[index] = built_costs[index] = 0.0f;
+        return index + 1;
+    }
+
+    // sweep the bins of every axis for the split with the lowest area * count on both sides
+    float best_cost = std::numeric_limits<float>::infinity();
+    int best_axis = -1, best_bin = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float low = component(centroids.min, axis), extent = component(centroids.max, axis) - low;
+        if (extent <= 0.0f)
+            continue;
+
+        bvh_box bin_bounds[BVH_SAH_BINS];
+        uint32_t bin_counts[BVH_SAH_BINS] = {};
+        for (bvh_box &box : bin_bounds)
+            box = empty_box();
+
+        float scale = BVH_SAH_BINS / extent;
+        for (uint32_t k = first; k < last; k++)
+        {
+            const bvh_box &box = items[order[k]];
+            int bin = std::min((int)((centroid(box, axis) - low) * scale), BVH_SAH_BINS - 1);
+            grow(bin_bounds[bin], box);
+            bin_counts[bin]++;
+        }
+
+        float right_areas[BVH_SAH_BINS];
+        uint32_t right_counts[BVH_SAH_BINS];
+        bvh_box right = empty_box();
+        uint32_t right_count = 0;
+        for (int bin = BVH_SAH_BINS - 1; bin > 0; bin--)
+        {
+            grow(right, bin_bounds[bin]);
+            right_count += bin_counts[bin];
+            right_areas[bin] = right_count ? surface_area(right) : 0.0f;
+            right_counts[bin] = right_count;
+        }
+
+        bvh_box left = empty_box();
+        uint32_t left_count = 0;
+        for (int bin = 0; bin < BVH_SAH_BINS - 1; bin++)
+        {
+            grow(left, bin_bounds[bin]);
+            left_count += bin_counts[bin];
+            if (left_count == 0 || right_counts[bin + 1] == 0)
+                continue;
+
+            float cost = surface_area(left) * left_count + right_areas[bin + 1] * right_counts[bin + 1];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = bin;
+            }
+        }
+    }
+
+    uint32_t mid;
+    if (best_axis >= 0)
+    {
+        float low = component(centroids.min, best_axis);
+        float scale = BVH_SAH_BINS / (component(centroids.max, best_axis) - low);
+        mid = (uint32_t)(std::partition(order.begin() + first, order.begin() + last, [this, best_axis, best_bin, low, scale](uint32_t item) {
+                             return std::min((int)((centroid(items[item], best_axis) - low) * scale), BVH_SAH_BINS - 1) <= best_bin;
+                         }) -
+                         order.begin());
+    }
+    else
+    {
+        // every centroid is in the same spot, any split is as good
+        mid = (first + last) / 2;
+    }
+
+    uint32_t right_index = build_node(index + 1, first, mid);
+    uint32_t end = build_node(right_index, mid, last);
+
+    nodes[index] = {bounds, end, BVH_NO_ITEM};
+    costs[index] = built_costs[index] = surface_area(bounds) + built_costs[index + 1] + built_costs[right_index];
+    return end;
+}
+
+void bvh::rebuild(uint32_t index)
+{
+    order.clear();
+    for (uint32_t i = index; i < nodes[index].end; i++)
+        if (nodes[i].item != BVH_NO_ITEM)
+            order.push_back(nodes[i].item);
+
+    build_node(index, 0, (uint32_t)order.size());
+}
+
+// update
+
+size_t bvh::refit()
+{
+    // children come after their parent, so walking backwards finishes them first
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        node &n = nodes[i];
+        if (n.item != BVH_NO_ITEM)
+        {
+            n.bounds = items[n.item];
+            continue;
+        }
+
+        uint32_t right = nodes[i + 1].end;
+        n.bounds = nodes[i + 1].bounds;
+        grow(n.bounds, nodes[right].bounds);
+        costs[i] = surface_area(n.bounds) + costs[i + 1] + costs[right];
+    }
+
+    size_t rebuilt = 0;
+    for (uint32_t i = 0; i < nodes.size();)
+    {
+        // small subtrees loosen quickly but cost little to walk, they're left to the rebuild of a bigger one
+        if (nodes[i].end - i < 2 * BVH_REBUILD_MIN_ITEMS - 1)
+        {
+            i = nodes[i].end;
+            continue;
+        }
+
+        if (costs[i] > built_costs[i] * BVH_REBUILD_GROWTH)
+        {
+            rebuild(i);
+            rebuilt++;
+            i = nodes[i].end;
+            continue;
+        }
+
+        i++;
+    }
+
+    return rebuilt;
+}
+
+// queries
+
+void bvh::cull(const frustum &view_frustum, std::vector<bvh_visible> &visible) const
+{
+    struct pending
+    {
+        uint32_t end;
+        unsigned char planes;
+    };
+    std::vector<pending> ancestors;
+
+    for (uint32_t i = 0; i < nodes.size();)
+    {
+        while (!ancestors.empty() && ancestors.back().end <= i)
+            ancestors.pop_back();
+
+        const node &n = nodes[i];
+        unsigned char planes = ancestors.empty() ? FRUSTUM_ALL_PLANES : ancestors.back().planes;
+        if (planes && !view_frustum.cull_box(n.bounds.min, n.bounds.max, planes))
+        {
+            i = n.end;
+            continue;
+        }
+
+        if (n.item != BVH_NO_ITEM)
+            visible.push_back({n.item, planes});
+        else if (planes == 0)
+        {
+            // entirely inside, everything below is visible
+            for (uint32_t k = i + 1; k < n.end; k++)
+                if (nodes[k].item != BVH_NO_ITEM)
+                    visible.push_back({nodes[k].item, 0});
+            i = n.end;
+            continue;
+        }
+        else
+            ancestors.push_back({n.end, planes});
+
+        i++;
+    }
+}
+
+bool bvh::raycast(const vector3 &origin, const vector3 &direction, float max_distance, uint32_t &item, float &distance) const
+{
+    vector3 inverse_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+    item = BVH_NO_ITEM;
+    distance = max_distance;
+    for (uint32_t i = 0; i < nodes.size();)
+    {
+        const node &n = nodes[i];
+        float entry = ray_entry(n.bounds, origin, inverse_direction, distance);
+        if (entry < 0.0f || (item != BVH_NO_ITEM && entry >= distance))
+        {
+            i = n.end;
+            continue;
+        }
+
+        if (n.item != BVH_NO_ITEM)
+        {
+            item = n.item;
+            distance = entry;
+        }
+        i++;
+    }
+
+    if (item == BVH_NO_ITEM)
+        distance = 0.0f;
+    return item != BVH_NO_ITEM;
+}
+
+void bvh::query_sphere(const vector3 &center, float radius, std::vector<uint32_t> &found) const
+{
+    for (uint32_t i = 0; i < nodes.size();)
+    {
+        const node &n = nodes[i];
+
+        float squared_distance = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float c = component(center, axis);
+            float gap = std::max(std::max(component(n.bounds.min, axis) - c, c - component(n.bounds.max, axis)), 0.0f);
+            squared_distance += gap * gap;
+        }
+
+        if (squared_distance > radius * radius)
+        {
+            i = n.end;
+            continue;
+        }
+
+        if (n.item != BVH_NO_ITEM)
+            found.push_back(n.item);
+        i++;
+    }
+}
+
+// getters
+
+float bvh::get_sah_cost() const
+{
+    if (nodes.empty())
+        return 0.0f;
+
+    float root_area = surface_area(nodes[0].bounds);
+    return root_area > 0.0f ? costs[0] / root_area : 0.0f;
+}
+
+// helpers
+
+// component wise, the vector3 operators aren't inlined and these run for every node and item
+
+float bvh::surface_area(const bvh_box &box)
+{
+    float x = box.max.x - box.min.x, y = box.max.y - box.min.y, z = box.max.z - box.min.z;
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+void bvh::grow(bvh_box &box, const bvh_box &other)
+{
+    box.min.x = std::min(box.min.x, other.min.x);
+    box.min.y = std::min(box.min.y, other.min.y);
+    box.min.z = std::min(box.min.z, other.min.z);
+    box.max.x = std::max(box.max.x, other.max.x);
+    box.max.y = std::max(box.max.y, other.max.y);
+    box.max.z = std::max(box.max.z, other.max.z);
+}
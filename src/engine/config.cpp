@@ -21,11 +21,6 @@ vector3 config::get_projection_settings()
 	return projection_attributes;
 }
 
-std::vector<group> config::get_root_groups()
-{
-	return root_groups;
-}
-
 camera *config::get_config_camera_init()
 {
 	return cam;
@@ -33,31 +28,22 @@ camera *config::get_config_camera_init()
 
 std::vector<vector3> config::query_group_postitions()
 {
-	std::vector<vector3> l_pos;
-	for (size_t i = 0; i < root_groups.size(); i++)
-	{
-		std::vector<vector3> c_locks = root_groups.at(i).query_group_positions();
-		l_pos.insert(l_pos.end(), c_locks.begin(), c_locks.end());
-	}
-	return l_pos;
+	return scene.query_positions();
 }
 
 // render / update groups
 
 void config::render_all_groups(matrix4x4 &camera_transform, frustum &view_frustum, bool frustum_cull, bool render_bounding_spheres, bool draw_translation_path)
 {
-	for (size_t i = 0; i < root_groups.size(); i++)
-	{
-		root_groups.at(i).render_group(camera_transform, view_frustum, frustum_cull, render_bounding_spheres, draw_translation_path);
-	}
+	scene.render(camera_transform, view_frustum, queue, frustum_cull, render_bounding_spheres, draw_translation_path);
 }
 
 void config::update_groups(int delta_time_ms)
 {
-	for (size_t i = 0; i < root_groups.size(); i++)
-	{
-		root_groups.at(i).update_group(delta_time_ms, matrix4x4::Identity());
-	}
+	if (update_pool)
+		scene.update(delta_time_ms, *update_pool);
+	else
+		scene.update(delta_time_ms);
 }
 
 // private
@@ -66,7 +52,32 @@ void config::load(const char *filepath)
 {
 	std::stringstream ss; // string stream for errors and stuff
 	tinyxml2::XMLDocument doc;
-	if (doc.LoadFile(filepath) != tinyxml2::XML_SUCCESS)
+	tinyxml2::XMLError load_result;
+
+	if (scene_pack::is_pack(filepath))
+	{
+		// the config and every asset it references come from a single mapping
+		std::shared_ptr<scene_pack> pack = std::make_shared<scene_pack>();
+		std::string error;
+		if (!pack->open(filepath, error))
+		{
+			ss << "Failed to open scene pack at: " << filepath << " (" << error << ")";
+			printer::print_exception(ss.str(), "config::load");
+			throw FailedToLoadException(ss.str());
+		}
+
+		load_result = doc.Parse(pack->get_config_data(), pack->get_config_size());
+
+		ss << "Mounted " << filepath << ": " << pack->get_entry_count() << " entries, " << pack->get_file_size() / 1024 << " KiB.";
+		printer::print_info(ss.str(), "config::load");
+		ss.str(std::string());
+
+		asset_loader::mount_pack(pack);
+	}
+	else
+		load_result = doc.LoadFile(filepath);
+
+	if (load_result != tinyxml2::XML_SUCCESS)
 	{
 		ss << "Failed to load XML config file at: " << filepath;
 		printer::print_exception(ss.str(), "config::load");
@@ -215,6 +226,7 @@ void config::load(const char *filepath)
 		}
 
 		bool loaded_group_at_least_once = false;
+		std::vector<group> root_groups;
 		tinyxml2::XMLElement *group_element = root->FirstChildElement("group");
 		while (group_element)
 		{
@@ -232,6 +244,16 @@ void config::load(const char *filepath)
 			printer::print_exception(ss.str(), "config::load");
 			throw FailedToLoadException(ss.str());
 		}
+		scene = scene_graph(root_groups);
+		if (scene.get_update_task_count() > 1)
+		{
+			update_pool = std::make_unique<work_stealing_pool>(0);
+
+			ss << "Scene update split into " << scene.get_update_task_count() << " tasks over " << update_pool->get_thread_count() << " thread(s).";
+			printer::print_info(ss.str(), "config::load");
+			ss.str(std::string());
+		}
+		texture_cache::finish_requests(); // every model has requested its texture by now
 
 		tinyxml2::XMLElement *lights = root->FirstChildElement("lights");
 		if (lights)
@@ -1,5 +1,9 @@
 #include "engine/frustum.hpp"
 
+unsigned char frustum::cull_kernel = frustum_kernels::supported(FRUSTUM_KERNEL_AVX2) ? FRUSTUM_KERNEL_AVX2
+                                     : frustum_kernels::supported(FRUSTUM_KERNEL_SSE) ? FRUSTUM_KERNEL_SSE
+                                                                                       : FRUSTUM_KERNEL_SCALAR;
+
 frustum::frustum()
 {
     left_plane = right_plane = top_plane = bottom_plane = near_plane = far_plane = vector4();
@@ -37,8 +41,105 @@ bool frustum::inside_frustum(vector3 position, float radius)
     return true;
 }
 
+bool frustum::inside_frustum(const vector3 &box_min, const vector3 &box_max, unsigned char planes) const
+{
+    const vector4 *all_planes[6] = {&left_plane, &right_plane, &top_plane, &bottom_plane, &near_plane, &far_plane};
+
+    for (int p = 0; p < 6; p++)
+    {
+        if (!(planes & (1 << p)))
+            continue;
+
+        const vector4 *plane = all_planes[p];
+
+        // the corner furthest along the plane normal, if even that one is behind the plane the whole box is
+        vector3 corner(plane->x >= 0 ? box_max.x : box_min.x,
+                       plane->y >= 0 ? box_max.y : box_min.y,
+                       plane->z >= 0 ? box_max.z : box_min.z);
+
+        if (vector3::dot(corner, vector3(plane->x, plane->y, plane->z)) + plane->w < 0)
+            return false;
+    }
+
+    return true;
+}
+
+bool frustum::cull_sphere(const vector3 &center, float radius, unsigned char &planes) const
+{
+    const vector4 *all_planes[6] = {&left_plane, &right_plane, &top_plane, &bottom_plane, &near_plane, &far_plane};
+
+    for (int p = 0; p < 6; p++)
+    {
+        if (!(planes & (1 << p)))
+            continue;
+
+        float dist = vector3::dot(center, vector3(all_planes[p]->x, all_planes[p]->y, all_planes[p]->z)) + all_planes[p]->w;
+        if (dist + radius < 0)
+            return false;
+        if (dist - radius >= 0)
+            planes &= ~(1 << p);
+    }
+
+    return true;
+}
+
+bool frustum::cull_box(const vector3 &box_min, const vector3 &box_max, unsigned char &planes) const
+{
+    const vector4 *all_planes[6] = {&left_plane, &right_plane, &top_plane, &bottom_plane, &near_plane, &far_plane};
+
+    for (int p = 0; p < 6; p++)
+    {
+        if (!(planes & (1 << p)))
+            continue;
+
+        const vector4 *plane = all_planes[p];
+        vector3 normal(plane->x, plane->y, plane->z);
+
+        // furthest corner along the normal decides if anything is in front, the nearest one if everything is
+        vector3 furthest(plane->x >= 0 ? box_max.x : box_min.x, plane->y >= 0 ? box_max.y : box_min.y, plane->z >= 0 ? box_max.z : box_min.z);
+        vector3 nearest(plane->x >= 0 ? box_min.x : box_max.x, plane->y >= 0 ? box_min.y : box_max.y, plane->z >= 0 ? box_min.z : box_max.z);
+
+        if (vector3::dot(furthest, normal) + plane->w < 0)
+            return false;
+        if (vector3::dot(nearest, normal) + plane->w >= 0)
+            planes &= ~(1 << p);
+    }
+
+    return true;
+}
+
+void frustum::cull_spheres(const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *planes) const
+{
+    const vector4 *all_planes[6] = {&left_plane, &right_plane, &top_plane, &bottom_plane, &near_plane, &far_plane};
+    float plane_values[6][4];
+    for (int p = 0; p < 6; p++)
+    {
+        plane_values[p][0] = all_planes[p]->x;
+        plane_values[p][1] = all_planes[p]->y;
+        plane_values[p][2] = all_planes[p]->z;
+        plane_values[p][3] = all_planes[p]->w;
+    }
+
+    frustum_kernels::kernel cull = frustum_kernels::get(cull_kernel);
+    (cull ? cull : frustum_kernels::cull_scalar)(plane_values, x, y, z, radius, count, planes);
+}
+
+float frustum::projected_size(const vector4 &view_position, float radius) const
+{
+    float depth = -view_position.z;
+    if (depth <= radius)
+        return std::numeric_limits<float>::max(); // camera is inside or right next to the sphere
+
+    return 2.0f * radius * screen_scale / depth;
+}
+
 // update
 
+void frustum::set_screen_scale(float fov, int viewport_height)
+{
+    screen_scale = viewport_height / (2.0f * tanf(fov * (float)M_PI / 360.0f));
+}
+
 void frustum::update_frustum(matrix4x4 &projection_view_matrix)
 {
     float left[4], right[4], top[4], bottom[4], near_p[4], far_p[4];
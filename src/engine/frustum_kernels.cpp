@@ -0,0 +1,215 @@
+#include "engine/frustum_kernels.hpp"
+
+#include <cstring>
+
+#ifdef FRUSTUM_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC takes intrinsics of any instruction set anywhere, GCC and Clang only in functions targeting it
+#if defined(FRUSTUM_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define FRUSTUM_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FRUSTUM_TARGET(isa)
+#endif
+
+namespace
+{
+    // same operations, in the same order, as frustum::cull_sphere
+    unsigned char cull_one(const float planes[6][4], float x, float y, float z, float radius, unsigned char mask)
+    {
+        for (int p = 0; p < 6; p++)
+        {
+            if (!(mask & (1 << p)))
+                continue;
+
+            float dist = x * planes[p][0] + y * planes[p][1] + z * planes[p][2] + planes[p][3];
+            if (dist + radius < 0)
+                return FRUSTUM_CULLED;
+            if (dist - radius >= 0)
+                mask &= ~(1 << p);
+        }
+        return mask;
+    }
+
+    void cull_tail(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t first, size_t count, unsigned char *masks)
+    {
+        for (size_t i = first; i < count; i++)
+            masks[i] = cull_one(planes, x[i], y[i], z[i], radius[i], masks[i]);
+    }
+
+    // a lane's bit p is set in plane p's compare results, so the lanes can be or-ed into plane masks with float ops
+    float plane_bit(int p)
+    {
+        uint32_t bit = 1u << p;
+        float lane;
+        memcpy(&lane, &bit, sizeof(lane));
+        return lane;
+    }
+
+    // outside and inside hold, per lane, the planes the sphere is entirely behind and entirely in front of
+    void apply_lanes(const float *outside, const float *inside, int lanes, unsigned char *masks)
+    {
+        uint32_t outside_planes[8], inside_planes[8];
+        memcpy(outside_planes, outside, lanes * sizeof(float));
+        memcpy(inside_planes, inside, lanes * sizeof(float));
+
+        // without branches, which lanes are culled is about as predictable as a coin flip
+        for (int lane = 0; lane < lanes; lane++)
+        {
+            uint32_t culled = 0u - (uint32_t)((outside_planes[lane] & masks[lane]) != 0);
+            masks[lane] = (unsigned char)((masks[lane] & ~inside_planes[lane] & ~culled) | (FRUSTUM_CULLED & culled));
+        }
+    }
+
+#ifdef FRUSTUM_KERNELS_X86
+    bool cpu_has(unsigned char kernel_type)
+    {
+#ifdef _MSC_VER
+        int registers[4];
+        __cpuid(registers, 1);
+        if (kernel_type == FRUSTUM_KERNEL_SSE)
+            return (registers[3] & (1 << 25)) != 0;
+
+        // AVX2 also needs the OS to save the upper halves of the registers
+        bool os_saves_avx = (registers[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(registers, 7, 0);
+        return os_saves_avx && (registers[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        if (kernel_type == FRUSTUM_KERNEL_SSE)
+            return __builtin_cpu_supports("sse");
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+}
+
+void frustum_kernels::cull_scalar(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *masks)
+{
+    cull_tail(planes, x, y, z, radius, 0, count, masks);
+}
+
+#ifdef FRUSTUM_KERNELS_X86
+
+FRUSTUM_TARGET("sse")
+void frustum_kernels::cull_sse(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *masks)
+{
+    __m128 normal_x[6], normal_y[6], normal_z[6], distance[6], bits[6];
+    for (int p = 0; p < 6; p++)
+    {
+        normal_x[p] = _mm_set1_ps(planes[p][0]);
+        normal_y[p] = _mm_set1_ps(planes[p][1]);
+        normal_z[p] = _mm_set1_ps(planes[p][2]);
+        distance[p] = _mm_set1_ps(planes[p][3]);
+        bits[p] = _mm_set1_ps(plane_bit(p));
+    }
+    __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 center_x = _mm_loadu_ps(x + i), center_y = _mm_loadu_ps(y + i), center_z = _mm_loadu_ps(z + i);
+        __m128 sphere_radius = _mm_loadu_ps(radius + i);
+
+        __m128 outside = zero, inside = zero;
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(center_x, normal_x[p]), _mm_mul_ps(center_y, normal_y[p])), _mm_mul_ps(center_z, normal_z[p])), distance[p]);
+            outside = _mm_or_ps(outside, _mm_and_ps(_mm_cmplt_ps(_mm_add_ps(dist, sphere_radius), zero), bits[p]));
+            inside = _mm_or_ps(inside, _mm_and_ps(_mm_cmpge_ps(_mm_sub_ps(dist, sphere_radius), zero), bits[p]));
+        }
+
+        float outside_lanes[4], inside_lanes[4];
+        _mm_storeu_ps(outside_lanes, outside);
+        _mm_storeu_ps(inside_lanes, inside);
+        apply_lanes(outside_lanes, inside_lanes, 4, masks + i);
+    }
+
+    cull_tail(planes, x, y, z, radius, i, count, masks);
+}
+
+FRUSTUM_TARGET("avx2")
+void frustum_kernels::cull_avx2(const float planes[6][4], const float *x, const float *y, const float *z, const float *radius, size_t count, unsigned char *masks)
+{
+    __m256 normal_x[6], normal_y[6], normal_z[6], distance[6], bits[6];
+    for (int p = 0; p < 6; p++)
+    {
+        normal_x[p] = _mm256_set1_ps(planes[p][0]);
+        normal_y[p] = _mm256_set1_ps(planes[p][1]);
+        normal_z[p] = _mm256_set1_ps(planes[p][2]);
+        distance[p] = _mm256_set1_ps(planes[p][3]);
+        bits[p] = _mm256_set1_ps(plane_bit(p));
+    }
+    __m256 zero = _mm256_setzero_ps();
+
+    // separate multiplies and adds, not FMA, so the rounding matches the scalar test
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 center_x = _mm256_loadu_ps(x + i), center_y = _mm256_loadu_ps(y + i), center_z = _mm256_loadu_ps(z + i);
+        __m256 sphere_radius = _mm256_loadu_ps(radius + i);
+
+        __m256 outside = zero, inside = zero;
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(center_x, normal_x[p]), _mm256_mul_ps(center_y, normal_y[p])), _mm256_mul_ps(center_z, normal_z[p])), distance[p]);
+            outside = _mm256_or_ps(outside, _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(dist, sphere_radius), zero, _CMP_LT_OQ), bits[p]));
+            inside = _mm256_or_ps(inside, _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(dist, sphere_radius), zero, _CMP_GE_OQ), bits[p]));
+        }
+
+        float outside_lanes[8], inside_lanes[8];
+        _mm256_storeu_ps(outside_lanes, outside);
+        _mm256_storeu_ps(inside_lanes, inside);
+        apply_lanes(outside_lanes, inside_lanes, 8, masks + i);
+    }
+
+    cull_tail(planes, x, y, z, radius, i, count, masks);
+}
+
+#endif
+
+bool frustum_kernels::supported(unsigned char kernel_type)
+{
+    if (kernel_type == FRUSTUM_KERNEL_SCALAR)
+        return true;
+
+#ifdef FRUSTUM_KERNELS_X86
+    static const bool has_sse = cpu_has(FRUSTUM_KERNEL_SSE);
+    static const bool has_avx2 = cpu_has(FRUSTUM_KERNEL_AVX2);
+
+    if (kernel_type == FRUSTUM_KERNEL_SSE)
+        return has_sse;
+    if (kernel_type == FRUSTUM_KERNEL_AVX2)
+        return has_avx2;
+#endif
+
+    return false;
+}
+
+frustum_kernels::kernel frustum_kernels::get(unsigned char kernel_type)
+{
+    if (!supported(kernel_type))
+        return NULL;
+
+#ifdef FRUSTUM_KERNELS_X86
+    if (kernel_type == FRUSTUM_KERNEL_SSE)
+        return cull_sse;
+    if (kernel_type == FRUSTUM_KERNEL_AVX2)
+        return cull_avx2;
+#endif
+
+    return cull_scalar;
+}
+
+const char *frustum_kernels::name(unsigned char kernel_type)
+{
+    if (kernel_type == FRUSTUM_KERNEL_SSE)
+        return "sse";
+    if (kernel_type == FRUSTUM_KERNEL_AVX2)
+        return "avx2";
+    return "scalar";
+}
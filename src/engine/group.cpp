@@ -1,39 +1,12 @@
 #include "engine/group.hpp"
 
-group::group(tinyxml2::XMLElement *root, float parent_scale)
+group::group(tinyxml2::XMLElement *root)
 {
-    model_matrix = matrix4x4::Identity();
-    group::parse_group(root, parent_scale);
+    model_matrix = world_matrix = matrix4x4::Identity();
+    group::parse_group(root);
 }
 
-// render / update
-
-void group::render_group(matrix4x4 &camera_transform, frustum &view_frustum, bool frustum_cull, bool render_bounding_spheres, bool draw_translation_path)
-{
-    glPushMatrix();
-    glMultMatrixf(model_matrix);
-
-    for (size_t i = 0; i < models.size(); i++)
-    {
-        model mod = models.at(i);
-        mod.render_model(view_frustum, frustum_cull, this->position, render_bounding_spheres, camera_transform);
-    }
-
-    for (size_t i = 0; i < sub_groups.size(); i++)
-    {
-        sub_groups.at(i).render_group(camera_transform, view_frustum, frustum_cull, render_bounding_spheres, draw_translation_path);
-    }
-
-    glPopMatrix();
-
-    if (draw_translation_path)
-    {
-        glDisable(GL_LIGHTING);
-        if (t)
-            t->draw_path();
-        glEnable(GL_LIGHTING);
-    }
-}
+// update
 
 void group::update_group(int delta_time_ms, matrix4x4 parent_transform)
 {
@@ -56,6 +29,7 @@ void group::update_group(int delta_time_ms, matrix4x4 parent_transform)
 
     // update position
     matrix4x4 full_transform = parent_transform * model_matrix;
+    world_matrix = full_transform;
     position.x = full_transform.get_data_at_point(3, 0);
     position.y = full_transform.get_data_at_point(3, 1);
     position.z = full_transform.get_data_at_point(3, 2);
@@ -68,10 +42,9 @@ void group::update_group(int delta_time_ms, matrix4x4 parent_transform)
 
 // parsing / loading
 
-void group::parse_group(tinyxml2::XMLElement *root, float parent_scale)
+void group::parse_group(tinyxml2::XMLElement *root)
 {
     std::stringstream ss; // used for exceptions
-    float bound_scaling = parent_scale;
     int current_transform = 0;
     tinyxml2::XMLElement *transform = root->FirstChildElement("transform");
     if (transform)
@@ -259,13 +232,6 @@ void group::parse_group(tinyxml2::XMLElement *root, float parent_scale)
                     throw FailedToParseGroupException(ss.str());
                 }
 
-                if (x >= y && x >= z)
-                    bound_scaling *= x;
-                else if (y >= z && y >= z)
-                    bound_scaling *= y;
-                else if (z >= y && z >= x)
-                    bound_scaling *= z;
-
                 this->s = matrix4x4::Scale(vector3(x, y, z));
             }
         }
@@ -284,7 +250,7 @@ void group::parse_group(tinyxml2::XMLElement *root, float parent_scale)
         while (model_element)
         {
             loaded_model_at_least_once = true;
-            this->models.push_back(model(model_element, bound_scaling));
+            this->models.push_back(model(model_element));
             model_element = model_element->NextSiblingElement("model");
         }
         if (!loaded_model_at_least_once)
@@ -308,7 +274,7 @@ void group::parse_group(tinyxml2::XMLElement *root, float parent_scale)
     tinyxml2::XMLElement *subgroup = root->FirstChildElement("group");
     for (subgroup; subgroup; subgroup = subgroup->NextSiblingElement("group"))
     {
-        group sub(subgroup, bound_scaling);
+        group sub(subgroup);
         sub_groups.push_back(sub);
     }
 }
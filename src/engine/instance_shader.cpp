@@ -0,0 +1,231 @@
+#include "engine/instance_shader.hpp"
+
+#include <cstddef>
+
+namespace
+{
+    const char *vertex_source = R"(#version 120
+attribute vec4 instance_world0;
+attribute vec4 instance_world1;
+attribute vec4 instance_world2;
+attribute vec4 instance_world3;
+attribute vec4 instance_diffuse;
+attribute vec4 instance_ambient;
+attribute vec4 instance_specular;
+attribute vec4 instance_emission;
+
+uniform vec4 dequantization;
+uniform int light_count;
+
+varying vec4 color;
+varying vec2 uv;
+
+void main()
+{
+    mat4 world = mat4(instance_world0, instance_world1, instance_world2, instance_world3);
+    vec4 eye = gl_ModelViewMatrix * (world * vec4(dequantization.xyz + gl_Vertex.xyz * dequantization.w, 1.0));
+
+    // cofactor matrix: the inverse transpose up to a scale, which normalize takes care of
+    mat3 linear = mat3(world[0].xyz, world[1].xyz, world[2].xyz);
+    mat3 cofactor = mat3(cross(linear[1], linear[2]), cross(linear[2], linear[0]), cross(linear[0], linear[1]));
+    float handedness = dot(linear[0], cross(linear[1], linear[2])) < 0.0 ? -1.0 : 1.0;
+    vec3 normal = normalize(gl_NormalMatrix * (cofactor * gl_Normal) * handedness);
+
+    vec3 view = normalize(-eye.xyz);
+    vec3 lit = instance_emission.rgb + instance_ambient.rgb * gl_LightModel.ambient.rgb;
+    for (int i = 0; i < 8; i++) // INSTANCE_SHADER_MAX_LIGHTS
+    {
+        if (i >= light_count)
+            break;
+
+        vec3 to_light;
+        float attenuation = 1.0;
+        if (gl_LightSource[i].position.w == 0.0)
+            to_light = normalize(gl_LightSource[i].position.xyz);
+        else
+        {
+            vec3 offset = gl_LightSource[i].position.xyz - eye.xyz;
+            float light_distance = length(offset);
+            to_light = offset / light_distance;
+            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation + gl_LightSource[i].linearAttenuation * light_distance +
+                                 gl_LightSource[i].quadraticAttenuation * light_distance * light_distance);
+
+            if (gl_LightSource[i].spotCutoff != 180.0)
+            {
+                float spot = dot(-to_light, normalize(gl_LightSource[i].spotDirection));
+                attenuation *= spot < gl_LightSource[i].spotCosCutoff ? 0.0 : pow(spot, gl_LightSource[i].spotExponent);
+            }
+        }
+
+        float diffuse = max(dot(normal, to_light), 0.0);
+        float specular = diffuse > 0.0 ? pow(max(dot(normal, normalize(to_light + view)), 0.0), instance_ambient.w) : 0.0;
+        lit += attenuation * (instance_ambient.rgb * gl_LightSource[i].ambient.rgb + instance_diffuse.rgb * gl_LightSource[i].diffuse.rgb * diffuse +
+                              instance_specular.rgb * gl_LightSource[i].specular.rgb * specular);
+    }
+
+    color = vec4(lit, instance_diffuse.a);
+    uv = (gl_TextureMatrix[0] * gl_MultiTexCoord0).xy;
+    gl_Position = gl_ProjectionMatrix * eye;
+}
+)";
+
+    const char *fragment_source = R"(#version 120
+uniform sampler2D texture_unit;
+uniform bool textured;
+
+varying vec4 color;
+varying vec2 uv;
+
+void main()
+{
+    gl_FragColor = textured ? color * texture2D(texture_unit, uv) : color;
+}
+)";
+
+    const char *attribute_names[] = {"instance_world0", "instance_world1", "instance_world2", "instance_world3",
+                                     "instance_diffuse", "instance_ambient", "instance_specular", "instance_emission"};
+
+    GLuint attribute_location(int attribute)
+    {
+        return attribute < 4 ? INSTANCE_ATTRIBUTE_WORLD + attribute : INSTANCE_ATTRIBUTE_MATERIAL + attribute - 4;
+    }
+}
+
+instance_shader::~instance_shader()
+{
+#ifndef __APPLE__
+    if (program)
+        glDeleteProgram(program);
+#endif
+}
+
+bool instance_shader::init()
+{
+    if (tried)
+        return is_ready();
+    tried = true;
+
+#ifdef __APPLE__
+    // legacy contexts there stop at OpenGL 2.1, without attribute divisors
+    printer::print_info("Instanced drawing needs OpenGL 3.3, drawing placements one at a time.", "instance_shader");
+    return false;
+#else
+    if (!GLEW_VERSION_3_3)
+    {
+        printer::print_info("Instanced drawing needs OpenGL 3.3, drawing placements one at a time.", "instance_shader");
+        return false;
+    }
+
+    GLuint vertex = compile(GL_VERTEX_SHADER, vertex_source);
+    GLuint fragment = compile(GL_FRAGMENT_SHADER, fragment_source);
+    if (!vertex || !fragment)
+    {
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        return false;
+    }
+
+    GLuint linked = glCreateProgram();
+    glAttachShader(linked, vertex);
+    glAttachShader(linked, fragment);
+    for (int a = 0; a < 8; a++)
+        glBindAttribLocation(linked, attribute_location(a), attribute_names[a]);
+    glLinkProgram(linked);
+
+    glDeleteShader(vertex); // flagged, freed along with the program
+    glDeleteShader(fragment);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(linked, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        char log[1024];
+        glGetProgramInfoLog(linked, sizeof(log), nullptr, log);
+        printer::print_warning(std::string("Instance shader didn't link, drawing placements one at a time: ") + log, "instance_shader");
+        glDeleteProgram(linked);
+        return false;
+    }
+
+    program = linked;
+    dequantization_location = glGetUniformLocation(program, "dequantization");
+    textured_location = glGetUniformLocation(program, "textured");
+    light_count_location = glGetUniformLocation(program, "light_count");
+    texture_unit_location = glGetUniformLocation(program, "texture_unit");
+
+    printer::print_info("Instanced drawing enabled.", "instance_shader");
+    return true;
+#endif
+}
+
+GLuint instance_shader::compile(GLenum type, const char *source)
+{
+#ifdef __APPLE__
+    return 0;
+#else
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        printer::print_warning(std::string("Instance shader didn't compile, drawing placements one at a time: ") + log, "instance_shader");
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+#endif
+}
+
+void instance_shader::begin(int light_count)
+{
+#ifndef __APPLE__
+    glUseProgram(program);
+    glUniform1i(light_count_location, light_count);
+    glUniform1i(texture_unit_location, 0);
+
+    for (int a = 0; a < 8; a++)
+    {
+        glEnableVertexAttribArray(attribute_location(a));
+        glVertexAttribDivisor(attribute_location(a), 1);
+    }
+#endif
+}
+
+void instance_shader::set_mesh(const vector4 &dequantization, bool textured)
+{
+#ifndef __APPLE__
+    glUniform4f(dequantization_location, dequantization.x, dequantization.y, dequantization.z, dequantization.w);
+    glUniform1i(textured_location, textured ? 1 : 0);
+#endif
+}
+
+void instance_shader::set_instances(size_t first)
+{
+#ifndef __APPLE__
+    size_t base = first * sizeof(instance_data);
+    for (int column = 0; column < 4; column++)
+        glVertexAttribPointer(attribute_location(column), 4, GL_FLOAT, GL_FALSE, sizeof(instance_data),
+                              reinterpret_cast<const void *>(base + offsetof(instance_data, world) + column * 4 * sizeof(float)));
+
+    size_t material_offsets[] = {offsetof(instance_data, diffuse), offsetof(instance_data, ambient), offsetof(instance_data, specular), offsetof(instance_data, emission)};
+    for (int m = 0; m < 4; m++)
+        glVertexAttribPointer(attribute_location(4 + m), 4, GL_FLOAT, GL_FALSE, sizeof(instance_data), reinterpret_cast<const void *>(base + material_offsets[m]));
+#endif
+}
+
+void instance_shader::end()
+{
+#ifndef __APPLE__
+    for (int a = 0; a < 8; a++)
+    {
+        glVertexAttribDivisor(attribute_location(a), 0);
+        glDisableVertexAttribArray(attribute_location(a));
+    }
+    glUseProgram(0);
+#endif
+}
@@ -32,6 +32,8 @@ typedef int (*PFNGLXSWAPINTERVALSGIPROC)(int);
 
 #include "external/tinyxml2.h"
 
+#include "engine/asset_loader.hpp"
+#include "engine/benchmark.hpp"
 #include "engine/config.hpp"
 #include "engine/group.hpp"
 #include "engine/camera.hpp"
@@ -132,6 +134,7 @@ void change_window_size(int w, int h)
 	float ratio = w * 1.0 / h;
 
 	projection_matrix = matrix4x4::Projection(cam_fov, ratio, cam_near, cam_far);
+	view_frustum.set_screen_scale(cam_fov, h);
 
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
@@ -195,19 +198,25 @@ void render_scene(void)
 	// render all meshes loaded in groups
 	cfg_obj->render_all_groups(view_matrix, view_frustum, frustum_cull, draw_bounding_spheres, draw_path);
 
-	/* frames++;
+	frames++;
 	int time = glutGet(GLUT_ELAPSED_TIME);
 	if (time - timebase > 1000)
 	{
 		fps = (float)frames * 1000.0 / (float)(time - timebase);
-		timebase = time;
-		frames = 0;
 
 		std::stringstream ss;
-		ss << fps;
+		ss << fps << " fps, " << model::triangles_drawn / frames << " triangles/frame" << (model::lod_enabled ? "" : " (LOD off)")
+		   << ", " << render_queue::draws / frames << " draws/frame (" << render_queue::instanced / frames << " instanced), " << render_queue::state_changes / frames << " state changes/frame";
 
 		glutSetWindowTitle(ss.str().data());
-	} */
+
+		timebase = time;
+		frames = 0;
+		model::triangles_drawn = 0;
+		render_queue::draws = 0;
+		render_queue::instanced = 0;
+		render_queue::state_changes = 0;
+	}
 
 	// End of frame
 	glutSwapBuffers();
@@ -222,6 +231,9 @@ void idle()
 	int delta_time_ms = current_time - prev_time;
 	prev_time = current_time;
 
+	// finish uploading whatever the loader threads have read since last frame
+	asset_loader::process_uploads();
+
 	if (update_groups)
 	{
 		cfg_obj->update_groups(delta_time_ms);
@@ -272,6 +284,10 @@ void processKeyPress(unsigned char c, int mouse_x, int mouse_y)
 		update_frustum_on_free_cam = !update_frustum_on_free_cam;
 		break;
 
+	case '9':
+		model::lod_enabled = !model::lod_enabled;
+		break;
+
 	case 'f':
 	case 'F':
 		cam->switch_camera_mode();
@@ -411,6 +427,9 @@ int main(int argc, char **argv)
 	printer::print_init();
 
 	std::stringstream ss;
+	if (argc >= 2 && std::string(argv[1]).compare("--benchmark") == 0)
+		return engine_benchmark::run(argc, argv);
+
 	if (argc != 2)
 	{
 		ss << "Wrong number of arguments!";
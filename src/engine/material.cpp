@@ -30,4 +30,15 @@ void material::apply_material()
     glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
     glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, emmissive);
     glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
+}
+
+bool material::operator==(const material &other) const
+{
+    const vector3 *mine[] = {&diffuse, &ambient, &specular, &emmissive};
+    const vector3 *theirs[] = {&other.diffuse, &other.ambient, &other.specular, &other.emmissive};
+    for (int i = 0; i < 4; i++)
+        if (mine[i]->x != theirs[i]->x || mine[i]->y != theirs[i]->y || mine[i]->z != theirs[i]->z)
+            return false;
+
+    return shininess == other.shininess;
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "engine/mesh.hpp"
+
+mesh::~mesh()
+{
+    GLuint buffers[] = {VBO, EBO, NORMAL_BUFFER, TEXTURE_COORDINATE_BUFFER};
+    glDeleteBuffers(4, buffers); // zeros are silently ignored
+}
+
+// render
+
+std::atomic<uint32_t> mesh::next_sort_id(0);
+
+void mesh::bind(bool use_normals, bool use_texture_coordinates)
+{
+    // element array bindings aren't touched by anything else, so it stays bound for every draw until the next bind
+    if (this->has_ebo)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+
+    if (this->quantized)
+    {
+        // positions are raw shorts, draw() scales them back
+        glVertexPointer(3, GL_SHORT, quantized_stride, 0);
+
+        size_t offset = 4 * sizeof(int16_t);
+        if (this->normals_loaded)
+        {
+            if (use_normals)
+                glNormalPointer(GL_INT_2_10_10_10_REV, quantized_stride, reinterpret_cast<const void *>(offset));
+            offset += sizeof(uint32_t);
+        }
+
+        if (use_texture_coordinates && this->texture_coordinates_loaded)
+            glTexCoordPointer(2, GL_HALF_FLOAT, quantized_stride, reinterpret_cast<const void *>(offset));
+
+        return;
+    }
+
+    if (this->interleaved)
+    {
+        // one buffer, every attribute at its own offset inside the vertex
+        GLsizei stride = MODEL_INTERLEAVED_STRIDE * sizeof(float);
+        glVertexPointer(3, GL_FLOAT, stride, 0);
+
+        if (use_normals)
+            glNormalPointer(GL_FLOAT, stride, reinterpret_cast<const void *>(3 * sizeof(float)));
+
+        if (use_texture_coordinates)
+            glTexCoordPointer(2, GL_FLOAT, stride, reinterpret_cast<const void *>(6 * sizeof(float)));
+
+        return;
+    }
+
+    glVertexPointer(3, GL_FLOAT, 0, 0);
+
+    if (use_normals && this->normals_loaded)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, this->NORMAL_BUFFER);
+        glNormalPointer(GL_FLOAT, 0, 0);
+    }
+
+    if (use_texture_coordinates && this->texture_coordinates_loaded)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, this->TEXTURE_COORDINATE_BUFFER);
+        glTexCoordPointer(2, GL_FLOAT, 0, 0);
+    }
+}
+
+void mesh::draw()
+{
+    if (this->quantized)
+    {
+        glPushMatrix();
+        glTranslatef(quantization.x, quantization.y, quantization.z);
+        glScalef(quantization.w / 32767.0f, quantization.w / 32767.0f, quantization.w / 32767.0f);
+    }
+
+    if (!this->has_ebo)
+    {
+        glDrawArrays(GL_TRIANGLES, 0, this->object_count);
+    }
+    else
+    {
+        glDrawElements(GL_TRIANGLES, this->object_count, this->index_type, 0);
+    }
+
+    if (this->quantized)
+        glPopMatrix();
+}
+
+void mesh::draw_instanced(GLsizei instance_count)
+{
+#ifndef __APPLE__
+    if (!this->has_ebo)
+        glDrawArraysInstanced(GL_TRIANGLES, 0, this->object_count, instance_count);
+    else
+        glDrawElementsInstanced(GL_TRIANGLES, this->object_count, this->index_type, 0, instance_count);
+#endif
+}
+
+vector4 mesh::get_dequantization() const
+{
+    if (!this->quantized)
+        return vector4(0.0f, 0.0f, 0.0f, 1.0f);
+
+    return vector4(quantization.x, quantization.y, quantization.z, quantization.w / 32767.0f);
+}
+
+// parsing / loading
+
+bool mesh::quantized_supported()
+{
+#ifdef __APPLE__
+    // legacy contexts there stop at OpenGL 2.1
+    bool supported = false;
+#else
+    bool supported = GLEW_VERSION_3_3 || (GLEW_ARB_vertex_type_2_10_10_10_rev && GLEW_ARB_half_float_vertex);
+#endif
+
+    static std::atomic<bool> reported{false};
+    if (!supported && !reported.exchange(true))
+        printer::print_info("Quantized meshes need OpenGL 3.3, dequantizing them on load.", "mesh");
+    return supported;
+}
+
+bool mesh::read(const std::string &filepath, mesh_staging &staging, std::string &error)
+{
+    if (!staging.file.open(filepath))
+    {
+        error = "Failed to open file!";
+        return false;
+    }
+
+    bool parsed = read(staging.file.data(), staging.file.size(), staging, error);
+    if (!staging.header)
+        staging.file.close(); // text, everything was copied out
+
+    return parsed;
+}
+
+bool mesh::read(const unsigned char *data, size_t size, mesh_staging &staging, std::string &error)
+{
+    staging.bytes = data;
+
+    bool parsed;
+    if (model_file::is_binary(data, size))
+    {
+        // the index section goes to GL as is, so it's checked here, on the worker, rather than trusted
+        staging.header = model_file::read_binary_header(data, size, error);
+        if (staging.header && !model_file::check_binary_indices(staging.header, data, error))
+            staging.header = nullptr;
+        if (!staging.header || !(staging.header->flags & MODEL_FLAG_QUANTIZED) || quantized_supported())
+            return staging.header != nullptr;
+
+        // compact attributes can't be drawn here, decode them and upload floats like a text file
+        staging.header = nullptr;
+        parsed = model_file::read_binary(data, size, staging.data, error);
+    }
+    else
+        parsed = model_file::parse_text(reinterpret_cast<const char *>(data), size, staging.data, error);
+    staging.bytes = nullptr; // everything was copied out
+
+    if (parsed && staging.data.can_interleave())
+    {
+        mesh_data &data = staging.data;
+        model_file::interleave(data.vertices.data(), data.normals.data(), data.tex_coords.data(), data.vertex_count(), staging.interleaved);
+
+        // only the interleaved copy gets uploaded
+        data.vertices = std::vector<float>();
+        data.normals = std::vector<float>();
+        data.tex_coords = std::vector<float>();
+    }
+
+    if (parsed && staging.data.has_indices() && staging.data.can_use_short_indices())
+    {
+        model_file::narrow_indices(staging.data.indices, staging.short_indices);
+        staging.data.indices = std::vector<uint32_t>();
+    }
+
+    return parsed;
+}
+
+void mesh::upload(const mesh_staging &staging)
+{
+    if (staging.header)
+    {
+        // binary: hand the mapped sections straight to GL
+        const model_file_header *header = staging.header;
+        const unsigned char *data = staging.bytes;
+        size_t vertex_count = header->vertex_count;
+
+        this->bounding_sphere = vector4(header->bounding_sphere[0], header->bounding_sphere[1], header->bounding_sphere[2], header->bounding_sphere[3]);
+        this->aabb_min = vector3(header->aabb_min[0], header->aabb_min[1], header->aabb_min[2]);
+        this->aabb_max = vector3(header->aabb_max[0], header->aabb_max[1], header->aabb_max[2]);
+
+        interleaved = header->flags & MODEL_FLAG_INTERLEAVED;
+        quantized = header->flags & MODEL_FLAG_QUANTIZED;
+
+        size_t vertex_size = (interleaved ? MODEL_INTERLEAVED_STRIDE : 3) * sizeof(float);
+        if (quantized)
+        {
+            vertex_size = quantized_stride = model_file::quantized_stride(header->flags);
+            quantization = vector4(header->quantization[0], header->quantization[1], header->quantization[2], header->quantization[3]);
+        }
+
+        VBO = create_buffer(GL_ARRAY_BUFFER, data + header->vertices_offset, vertex_count * vertex_size);
+        object_count = vertex_count;
+
+        if (header->flags & MODEL_FLAG_INDICES)
+        {
+            has_ebo = true;
+            index_type = (header->flags & MODEL_FLAG_SHORT_INDICES) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            EBO = create_buffer(GL_ELEMENT_ARRAY_BUFFER, data + header->indices_offset, header->index_count * (index_type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t)));
+            object_count = header->index_count;
+        }
+
+        normals_loaded = header->flags & MODEL_FLAG_NORMALS;
+        texture_coordinates_loaded = header->flags & MODEL_FLAG_TEXTURE_COORDINATES;
+
+        if (normals_loaded && !interleaved && !quantized)
+        {
+            NORMAL_BUFFER = create_buffer(GL_ARRAY_BUFFER, data + header->normals_offset, vertex_count * 3 * sizeof(float));
+        }
+
+        if (texture_coordinates_loaded && !interleaved && !quantized)
+        {
+            TEXTURE_COORDINATE_BUFFER = create_buffer(GL_ARRAY_BUFFER, data + header->tex_coords_offset, vertex_count * 2 * sizeof(float));
+        }
+    }
+    else
+    {
+        const mesh_data &data = staging.data;
+
+        this->bounding_sphere = data.bounding_sphere;
+        this->aabb_min = data.aabb_min;
+        this->aabb_max = data.aabb_max;
+
+        if (!staging.interleaved.empty())
+        {
+            interleaved = normals_loaded = texture_coordinates_loaded = true;
+            VBO = create_buffer(GL_ARRAY_BUFFER, staging.interleaved.data(), staging.interleaved.size() * sizeof(float));
+            object_count = staging.interleaved.size() / MODEL_INTERLEAVED_STRIDE;
+        }
+        else
+        {
+            VBO = create_buffer(GL_ARRAY_BUFFER, data.vertices.data(), data.vertices.size() * sizeof(float));
+            object_count = data.vertex_count();
+        }
+
+        if (!staging.short_indices.empty())
+        {
+            has_ebo = true;
+            index_type = GL_UNSIGNED_SHORT;
+            EBO = create_buffer(GL_ELEMENT_ARRAY_BUFFER, staging.short_indices.data(), staging.short_indices.size() * sizeof(uint16_t));
+            object_count = staging.short_indices.size();
+        }
+        else if (data.has_indices())
+        {
+            has_ebo = true;
+            EBO = create_buffer(GL_ELEMENT_ARRAY_BUFFER, data.indices.data(), data.indices.size() * sizeof(uint32_t));
+            object_count = data.indices.size();
+        }
+
+        if (data.has_normals())
+        {
+            normals_loaded = true;
+            NORMAL_BUFFER = create_buffer(GL_ARRAY_BUFFER, data.normals.data(), data.normals.size() * sizeof(float));
+        }
+
+        if (data.has_tex_coords())
+        {
+            texture_coordinates_loaded = true;
+            TEXTURE_COORDINATE_BUFFER = create_buffer(GL_ARRAY_BUFFER, data.tex_coords.data(), data.tex_coords.size() * sizeof(float));
+        }
+    }
+
+    resident = true;
+}
+
+GLuint mesh::create_buffer(GLenum target, const void *data, size_t size)
+{
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    glBufferData(target, size, data, GL_STATIC_DRAW);
+
+    buffer_size += size;
+    return buffer;
+}
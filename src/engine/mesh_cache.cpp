@@ -0,0 +1,99 @@
+#include "engine/mesh_cache.hpp"
+
+namespace
+{
+    std::unordered_map<std::string, std::weak_ptr<mesh>> meshes;
+
+    size_t hits = 0;
+    size_t misses = 0;
+
+    std::string canonical_path(const std::string &filepath)
+    {
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::weakly_canonical(filepath, error);
+        if (error)
+            return filepath; // let the mesh loader report the actual problem
+
+        return path.string();
+    }
+}
+
+std::shared_ptr<mesh> mesh_cache::acquire(const std::string &filepath)
+{
+    std::string key = canonical_path(filepath);
+
+    auto found = meshes.find(key);
+    if (found != meshes.end())
+    {
+        std::shared_ptr<mesh> resident = found->second.lock();
+        if (resident)
+        {
+            hits++;
+            return resident;
+        }
+    }
+
+    misses++;
+    std::shared_ptr<mesh> loaded = std::make_shared<mesh>();
+    meshes[key] = loaded;
+
+    asset_loader::submit([loaded, filepath]() {
+        std::shared_ptr<mesh_staging> staging = std::make_shared<mesh_staging>();
+        std::string error;
+        const unsigned char *packed;
+        size_t packed_size;
+        bool read = asset_loader::find_packed(filepath, packed, packed_size) ? mesh::read(packed, packed_size, *staging, error) : mesh::read(filepath, *staging, error);
+        if (!read)
+        {
+            printer::print_exception(filepath + ": " + error, "mesh_cache");
+            return; // never becomes resident, so models using it are never drawn
+        }
+
+        asset_loader::queue_upload([loaded, staging]() { loaded->upload(*staging); });
+    });
+
+    return loaded;
+}
+
+void mesh_cache::print_stats()
+{
+    size_t resident_count = 0;
+    size_t failed_count = 0;
+    size_t resident_bytes = 0;
+    size_t short_index_count = 0;
+    size_t index_bytes_saved = 0;
+    for (const auto &entry : meshes)
+    {
+        std::shared_ptr<mesh> resident = entry.second.lock();
+        if (!resident)
+            continue;
+
+        if (!resident->is_resident())
+        {
+            failed_count++;
+            continue;
+        }
+
+        resident_count++;
+        resident_bytes += resident->get_buffer_size();
+
+        if (resident->get_index_bytes_saved() > 0)
+        {
+            short_index_count++;
+            index_bytes_saved += resident->get_index_bytes_saved();
+        }
+    }
+
+    std::stringstream ss;
+    ss << "Mesh cache: " << hits + misses << " request(s), " << hits << " hit(s), " << misses << " miss(es). "
+       << resident_count << " unique mesh(es) resident using " << resident_bytes / 1024 << " KiB of buffers";
+    if (failed_count > 0)
+        ss << ", " << failed_count << " failed to load";
+    ss << ".";
+    printer::print_info(ss.str(), "mesh_cache");
+
+    ss.str(std::string());
+    ss << "16-bit indices: " << short_index_count << " of " << resident_count << " mesh(es), saving "
+       << index_bytes_saved / 1024 << " KiB of index memory across the scene.";
+    printer::print_info(ss.str(), "mesh_cache");
+}
@@ -1,13 +1,31 @@
 #include "engine/model.hpp"
 
-model::model(tinyxml2::XMLElement *root, float bound_scale_factor)
+bool model::lod_enabled = true;
+size_t model::triangles_drawn = 0;
+
+model::model(tinyxml2::XMLElement *root)
 {
-    parse_model(root, bound_scale_factor);
+    parse_model(root);
 }
 
-void model::render_model(frustum &view_frustum, bool frustum_cull, vector3 &position, bool render_bounding_sphere, matrix4x4 &camera_transform)
+void model::queue_model(frustum &view_frustum, bool frustum_cull, unsigned char cull_planes, const matrix4x4 &world_matrix, const vector4 &world_sphere, bool render_bounding_sphere, matrix4x4 &camera_transform, render_queue &queue)
 {
-    if (render_bounding_sphere)
+    // assets are still streaming in, skip the model until everything it needs is on the GPU
+    if (this->tex && !this->tex->is_resident())
+        return;
+
+    // nothing streamed in yet, nothing to draw
+    size_t level_count = this->lods.size() + 1;
+    size_t resident_level = 0;
+    while (resident_level < level_count && !lod_geometry(resident_level)->is_resident())
+        resident_level++;
+    if (resident_level == level_count)
+        return;
+
+    vector3 position(world_sphere.x, world_sphere.y, world_sphere.z);
+
+    // the sphere is infinite for a frame when the mesh just streamed in, the box still culls
+    if (render_bounding_sphere && !std::isinf(world_sphere.w))
     {
         glDisable(GL_LIGHTING);
 
@@ -18,8 +36,7 @@ void model::render_model(frustum &view_frustum, bool frustum_cull, vector3 &posi
         glLoadIdentity();
         glMultMatrixf(camera_transform);
         glTranslatef(position.x, position.y, position.z);
-        glTranslatef(bounding_sphere.x, bounding_sphere.y, bounding_sphere.z);
-        glutWireSphere(bounding_sphere.w, 10, 10);
+        glutWireSphere(world_sphere.w, 10, 10);
 
         glPopMatrix();
 
@@ -27,54 +44,150 @@ void model::render_model(frustum &view_frustum, bool frustum_cull, vector3 &posi
     }
 
 #ifndef IGNORE_FRUSTUM_CULL
-    if (frustum_cull && !view_frustum.inside_frustum(position, bounding_sphere.w))
-        return;
+    // the sphere test already dropped the planes the sphere is entirely inside of, the box can't cross those either
+    if (frustum_cull && cull_planes)
+    {
+        vector3 box_min, box_max;
+        world_bounds(world_matrix, box_min, box_max);
+        if (!view_frustum.inside_frustum(box_min, box_max, cull_planes))
+            return;
+    }
 #endif
 
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glVertexPointer(3, GL_FLOAT, 0, 0);
-
-    if (this->has_normals)
+    if (lod_enabled && !this->lods.empty())
     {
-        this->mat.apply_material();
-        glBindBuffer(GL_ARRAY_BUFFER, this->NORMAL_BUFFER);
-        glNormalPointer(GL_FLOAT, 0, 0);
+        vector4 view_position = camera_transform * vector4(position.x, position.y, position.z, 1.0f);
+        select_lod(view_frustum.projected_size(view_position, world_sphere.w));
     }
+    else
+        this->current_lod = 0;
 
-    if (this->has_texture_coordinates)
-    {
-        glEnable(GL_TEXTURE_2D);
-        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    // draw the closest level that is resident, preferring more detail
+    size_t level = this->current_lod;
+    while (level > 0 && !lod_geometry(level)->is_resident())
+        level--;
+    while (level < level_count && !lod_geometry(level)->is_resident())
+        level++;
 
-        glBindTexture(GL_TEXTURE_2D, this->TEXTURE);
+    mesh &drawn = *lod_geometry(level);
 
-        glBindBuffer(GL_ARRAY_BUFFER, this->TEXTURE_COORDINATE_BUFFER);
-        glTexCoordPointer(2, GL_FLOAT, 0, 0);
-    }
-    else
-    {
-        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-        glDisable(GL_TEXTURE_2D);
-    }
+    bool has_texture_coordinates = drawn.has_texture_coordinates() && this->tex;
+    queue.push(drawn, has_texture_coordinates ? this->tex.get() : nullptr, this->mat, world_matrix);
+    triangles_drawn += drawn.get_triangle_count();
+}
 
-    if (!this->has_ebo)
+bool model::world_bounding_sphere(const matrix4x4 &world_matrix, vector4 &sphere) const
+{
+    vector4 local;
+    vector3 local_min, local_max;
+    if (!local_bounds(local, local_min, local_max))
+        return false;
+
+    // the center is a point, so translation, rotation and scale all move it. the radius grows with the longest axis, a
+    // sphere squashed by uneven scales still fits inside one that big
+    sphere = world_matrix * vector4(local.x, local.y, local.z, 1.0f);
+    sphere.w = local.w * max_axis_scale(world_matrix);
+    return true;
+}
+
+float model::max_axis_scale(const matrix4x4 &world_matrix)
+{
+    // column major, the first three columns are the model's axes in world space
+    const float *m = world_matrix;
+    float longest = 0.0f;
+    for (int column = 0; column < 3; column++)
     {
-        glDrawArrays(GL_TRIANGLES, 0, this->object_count);
+        float x = m[column * 4], y = m[column * 4 + 1], z = m[column * 4 + 2];
+        longest = std::max(longest, x * x + y * y + z * z);
     }
-    else
+
+    return sqrtf(longest);
+}
+
+bool model::world_bounds(const matrix4x4 &world_matrix, vector3 &box_min, vector3 &box_max) const
+{
+    vector4 local_sphere;
+    vector3 local_min, local_max;
+    if (!local_bounds(local_sphere, local_min, local_max))
+        return false;
+
+    world_bounding_box(local_min, local_max, world_matrix, box_min, box_max);
+    return true;
+}
+
+bool model::bounds_final() const
+{
+    for (size_t level = 0; level < this->lods.size() + 1; level++)
+        if (!lod_geometry(level)->is_resident())
+            return false;
+    return true;
+}
+
+bool model::local_bounds(vector4 &sphere, vector3 &box_min, vector3 &box_max) const
+{
+    // levels stream in coarsest first and the coarse hulls can be smaller, so every resident one is enclosed and the
+    // bounds only ever grow as finer levels arrive
+    bool any_resident = false;
+    sphere = vector4(0.0f, 0.0f, 0.0f, -1.0f);
+    for (size_t level = 0; level < this->lods.size() + 1; level++)
     {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
-        glDrawElements(GL_TRIANGLES, this->object_count, GL_UNSIGNED_INT, 0);
+        const mesh &level_mesh = *lod_geometry(level);
+        if (!level_mesh.is_resident())
+            continue;
+
+        math_utils::merge_spheres(sphere, level_mesh.get_bounding_sphere());
+        const vector3 &level_min = level_mesh.get_aabb_min(), &level_max = level_mesh.get_aabb_max();
+        if (!any_resident)
+        {
+            box_min = level_min;
+            box_max = level_max;
+        }
+        else
+        {
+            box_min = vector3(std::min(box_min.x, level_min.x), std::min(box_min.y, level_min.y), std::min(box_min.z, level_min.z));
+            box_max = vector3(std::max(box_max.x, level_max.x), std::max(box_max.y, level_max.y), std::max(box_max.z, level_max.z));
+        }
+        any_resident = true;
     }
 
-    if (this->has_texture_coordinates)
+    return any_resident;
+}
+
+void model::world_bounding_box(const vector3 &local_min, const vector3 &local_max, const matrix4x4 &world_matrix, vector3 &box_min, vector3 &box_max)
+{
+    float center[3] = {(local_min.x + local_max.x) * 0.5f, (local_min.y + local_max.y) * 0.5f, (local_min.z + local_max.z) * 0.5f};
+    float extent[3] = {(local_max.x - local_min.x) * 0.5f, (local_max.y - local_min.y) * 0.5f, (local_max.z - local_min.z) * 0.5f};
+
+    // transformed center plus the box extents projected on each world axis (Arvo), column major like OpenGL
+    const float *m = world_matrix;
+    float world_center[3], world_extent[3];
+    for (int row = 0; row < 3; row++)
     {
-        glBindTexture(GL_TEXTURE_2D, 0);
+        world_center[row] = m[12 + row];
+        world_extent[row] = 0.0f;
+        for (int column = 0; column < 3; column++)
+        {
+            world_center[row] += m[column * 4 + row] * center[column];
+            world_extent[row] += fabsf(m[column * 4 + row]) * extent[column];
+        }
     }
-    return;
+
+    box_min = vector3(world_center[0] - world_extent[0], world_center[1] - world_extent[1], world_center[2] - world_extent[2]);
+    box_max = vector3(world_center[0] + world_extent[0], world_center[1] + world_extent[1], world_center[2] + world_extent[2]);
 }
 
-void model::parse_model(tinyxml2::XMLElement *root, float bound_scale_factor)
+void model::select_lod(float screen_size)
+{
+    // step towards coarser levels while clearly below their threshold
+    while (this->current_lod < this->lods.size() && screen_size < this->lods[this->current_lod].max_screen_size * (1.0f - LOD_HYSTERESIS))
+        this->current_lod++;
+
+    // and back towards finer ones while clearly above the current level's threshold
+    while (this->current_lod > 0 && screen_size > this->lods[this->current_lod - 1].max_screen_size * (1.0f + LOD_HYSTERESIS))
+        this->current_lod--;
+}
+
+void model::parse_model(tinyxml2::XMLElement *root)
 {
     std::stringstream ss;
 
@@ -87,7 +200,28 @@ void model::parse_model(tinyxml2::XMLElement *root, float bound_scale_factor)
         throw FailedToParseModelException("");
     }
 
-    parse_file(filepath, bound_scale_factor);
+    // the mesh is loaded asynchronously, so whether it has normals or texture coordinates is only known at render time
+    this->geometry = mesh_cache::acquire(filepath);
+
+    tinyxml2::XMLElement *lod = root->FirstChildElement("lod");
+    while (lod)
+    {
+        const char *lod_filepath;
+        float max_screen_size;
+        if (lod->QueryStringAttribute("file", &lod_filepath) != tinyxml2::XML_SUCCESS || lod->QueryFloatAttribute("below", &max_screen_size) != tinyxml2::XML_SUCCESS || max_screen_size <= 0)
+        {
+            printer::print_exception("file or below attribute of lod element is either missing or invalid! below must be a positive size in pixels.");
+            throw FailedToParseModelException("");
+        }
+
+        this->lods.push_back({mesh_cache::acquire(lod_filepath), max_screen_size});
+        lod = lod->NextSiblingElement("lod");
+    }
+
+    // coarser levels kick in at smaller sizes, whatever order they were written in
+    std::sort(this->lods.begin(), this->lods.end(), [](const lod_level &a, const lod_level &b) {
+        return a.max_screen_size > b.max_screen_size;
+    });
 
     tinyxml2::XMLElement *texture = root->FirstChildElement("texture");
     if (texture)
@@ -96,33 +230,16 @@ void model::parse_model(tinyxml2::XMLElement *root, float bound_scale_factor)
         tinyxml2::XMLError tex_result = texture->QueryStringAttribute("file", &tex_filepath);
         if (tex_result != tinyxml2::XML_SUCCESS)
         {
-            if (this->has_texture_coordinates)
-            {
-                printer::print_exception("Model has texture coordinates but no valid texture filepath.");
-                throw FailedToParseModelException("");
-            }
-        }
-        else
-        {
-            if (this->has_texture_coordinates)
-                this->load_texture(tex_filepath);
-            else
-            {
-                printer::print_warning("Valid texture filepath was found but model doesn't have texture coordinates. The texture will not be loaded.");
-            }
-        }
-    }
-    else
-    {
-        if (this->has_texture_coordinates)
-        {
-            printer::print_warning("Model's file has texture coordinates but no texture element was found. The 'has_texture_coordinates' flag is no longer set for this model.");
-            this->has_texture_coordinates = false;
+            printer::print_exception("file attribute of texture element is either missing or not a valid string!");
+            throw FailedToParseModelException("");
         }
-    }
 
-    if (!this->has_texture_coordinates)
-        this->TEXTURE = 0;
+        // atlased textures can't repeat, so only models that know their texture coordinates stay in [0, 1] opt in
+        bool atlas = false;
+        texture->QueryBoolAttribute("atlas", &atlas);
+
+        this->tex = texture_cache::acquire(tex_filepath, atlas);
+    }
 
     tinyxml2::XMLElement *color = root->FirstChildElement("color");
     if (color)
@@ -238,185 +355,3 @@ void model::parse_model(tinyxml2::XMLElement *root, float bound_scale_factor)
         this->mat = material();
     }
 }
-
-void model::parse_file(const std::string &filepath, float bound_scale_factor)
-{
-    std::stringstream ss;
-    std::ifstream file(filepath);
-
-    if (!file.is_open())
-    {
-        ss << "Failed to open file: " << filepath;
-        printer::print_exception(ss.str(), "model file_parse");
-        throw FailedToParseModelException("");
-    }
-
-    std::vector<float> vertices;
-    std::vector<int> indices;
-    std::vector<float> normals;
-    std::vector<float> tex_coords;
-
-    std::string line;
-    std::vector<char> data_order;
-    int line_index = 0;
-    while (std::getline(file, line))
-    {
-        std::stringstream ss(line);
-        std::string token;
-
-        if (line_index == 0)
-        {
-            const char *line_data = line.data();
-            if (line_data[0] == '1')
-            {
-                has_ebo = true;
-                data_order.push_back('i');
-            }
-
-            if (line_data[1] == '1')
-            {
-                has_normals = true;
-                data_order.push_back('n');
-            }
-
-            if (line_data[2] == '1')
-            {
-                has_texture_coordinates = true;
-                data_order.push_back('t');
-            }
-        }
-        else if (line_index == 1)
-        {
-            std::vector<float> bounding_sphere_info_vector;
-            while (std::getline(ss, token, ';'))
-            {
-                float bounding_info_token = std::stof(token);
-                bounding_sphere_info_vector.push_back(bounding_info_token);
-            }
-
-            this->bounding_sphere = vector4(bounding_sphere_info_vector.at(0), bounding_sphere_info_vector.at(1), bounding_sphere_info_vector.at(2), bounding_sphere_info_vector.at(3) * bound_scale_factor);
-        }
-        else if (line_index == 2)
-        { // vertices
-            while (std::getline(ss, token, ';'))
-            {
-                float vertex_float = std::stof(token);
-                vertices.push_back(vertex_float);
-            }
-
-            glGenBuffers(1, &VBO);
-            glBindBuffer(GL_ARRAY_BUFFER, VBO);
-            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-            if (!has_ebo)
-            {
-                object_count = vertices.size() / 3;
-            }
-        }
-        else
-        { // all the others
-            if (data_order.size() == 0)
-                break; // only indices
-
-            if (line_index - 3 > data_order.size())
-            {
-                printer::print_warning("Unexpected data at the end of file. Perhaps a flag isn't set? Ignoring extra data... \n");
-                break;
-            }
-
-            if (data_order.at(line_index - 3) == 'i')
-            {
-                // read indices
-                while (std::getline(ss, token, ';'))
-                {
-                    int index = std::stoi(token);
-                    indices.push_back(index);
-                }
-
-                glGenBuffers(1, &EBO);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(int) * indices.size(), indices.data(), GL_STATIC_DRAW);
-
-                object_count = indices.size();
-            }
-            else if (data_order.at(line_index - 3) == 'n')
-            {
-                // read normals
-                // unused for now
-                while (std::getline(ss, token, ';'))
-                {
-                    float normal_float = std::stof(token);
-                    normals.push_back(normal_float);
-                }
-
-                glGenBuffers(1, &NORMAL_BUFFER);
-                glBindBuffer(GL_ARRAY_BUFFER, NORMAL_BUFFER);
-                glBufferData(GL_ARRAY_BUFFER, sizeof(float) * normals.size(), normals.data(), GL_STATIC_DRAW);
-            }
-            else if (data_order.at(line_index - 3) == 't')
-            {
-                // read texture coordinates
-                while (std::getline(ss, token, ';'))
-                {
-                    float tex_float = std::stof(token);
-                    tex_coords.push_back(tex_float);
-                }
-
-                glGenBuffers(1, &TEXTURE_COORDINATE_BUFFER);
-                glBindBuffer(GL_ARRAY_BUFFER, TEXTURE_COORDINATE_BUFFER);
-                glBufferData(GL_ARRAY_BUFFER, tex_coords.size() * sizeof(float), tex_coords.data(), GL_STATIC_DRAW);
-            }
-        }
-
-        line_index++;
-    }
-
-    file.close();
-}
-
-void model::load_texture(const std::string &filepath)
-{
-    // std::stringstream ss;
-    // ss << "load_texture has been called (" << filepath << ")...";
-    // printer::print_info(ss.str());
-
-    // ss.clear();
-    // ss.str(std::string());
-
-    // ss << "Image path converted: " << (ILstring)filepath.data();
-    // printer::print_info(ss.str());
-
-    unsigned int tw, th;
-    unsigned char *tex_data;
-    ILuint t;
-    ilGenImages(1, &t);
-    ilBindImage(t);
-
-    // printer::print_info("Trying to load image...");
-    ilLoadImage((ILstring)filepath.data());
-    // printer::print_info("Done!");
-
-    tw = ilGetInteger(IL_IMAGE_WIDTH);
-    th = ilGetInteger(IL_IMAGE_HEIGHT);
-
-    // ss.clear();
-    // ss.str(std::string());
-
-    // ss << "tw: " << tw << " || th: " << th;
-    // printer::print_info(ss.str());
-
-    ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
-    tex_data = ilGetData();
-
-    glGenTextures(1, &this->TEXTURE);
-
-    glBindTexture(GL_TEXTURE_2D, this->TEXTURE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tw, th, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex_data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-}
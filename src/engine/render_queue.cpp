@@ -0,0 +1,275 @@
+#include "engine/render_queue.hpp"
+
+#include <cstring>
+
+size_t render_queue::draws = 0;
+size_t render_queue::instanced = 0;
+size_t render_queue::state_changes = 0;
+
+#define RENDER_KEY_TEXTURE_BITS 12 // < -- textures on the same atlas page, under the page's GL name
+#define RENDER_KEY_MESH_BITS 20
+#define RENDER_KEY_MATERIAL_BITS 12
+
+render_queue::~render_queue()
+{
+    glDeleteBuffers(1, &instance_buffer);
+}
+
+void render_queue::clear()
+{
+    records.clear();
+}
+
+uint32_t render_queue::intern_material(const material &mat)
+{
+    // scenes have a handful of distinct materials, a linear search beats hashing floats
+    for (size_t i = 0; i < materials.size(); i++)
+        if (materials[i] == mat)
+            return (uint32_t)i;
+
+    materials.push_back(mat);
+    return (uint32_t)materials.size() - 1;
+}
+
+void render_queue::push(mesh &geometry, const texture *tex, const material &mat, const matrix4x4 &world_matrix)
+{
+    draw_record record;
+    record.geometry = &geometry;
+    record.tex = tex;
+    record.material_index = intern_material(mat);
+    record.use_normals = geometry.has_normals();
+    record.world_matrix = &world_matrix;
+
+    // the page alone would leave an atlas page's textures interleaved, each switch breaking a run
+    uint64_t texture_id = tex ? tex->get_id() : 0;
+    uint64_t texture_sort_id = tex ? tex->get_sort_id() & ((1u << RENDER_KEY_TEXTURE_BITS) - 1) : 0;
+    uint64_t material_index = record.use_normals ? record.material_index : 0; // unlit draws don't care
+    record.key = (texture_id << (RENDER_KEY_TEXTURE_BITS + RENDER_KEY_MESH_BITS + RENDER_KEY_MATERIAL_BITS)) |
+                 (texture_sort_id << (RENDER_KEY_MESH_BITS + RENDER_KEY_MATERIAL_BITS)) |
+                 ((uint64_t)(geometry.get_sort_id() & ((1u << RENDER_KEY_MESH_BITS) - 1)) << RENDER_KEY_MATERIAL_BITS) |
+                 (material_index & ((1u << RENDER_KEY_MATERIAL_BITS) - 1));
+
+    records.push_back(record);
+}
+
+void render_queue::sort()
+{
+    if (records.size() < 2)
+        return;
+
+    sort_buffer.resize(records.size());
+
+    // bytes set in some key but not in all of them are the only ones worth a pass
+    uint64_t any_set = 0, all_set = ~0ull;
+    for (const draw_record &record : records)
+    {
+        any_set |= record.key;
+        all_set &= record.key;
+    }
+    uint64_t varying = any_set & ~all_set;
+
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        if (((varying >> shift) & 0xFF) == 0)
+            continue;
+
+        size_t offsets[256] = {0};
+        for (const draw_record &record : records)
+            offsets[(record.key >> shift) & 0xFF]++;
+
+        size_t total = 0;
+        for (size_t &offset : offsets)
+        {
+            size_t count = offset;
+            offset = total;
+            total += count;
+        }
+
+        // stable, so earlier passes' order survives within equal bytes
+        for (const draw_record &record : records)
+            sort_buffer[offsets[(record.key >> shift) & 0xFF]++] = record;
+        records.swap(sort_buffer);
+    }
+}
+
+void render_queue::prepare_instances()
+{
+    instances.clear();
+    batches.clear();
+    if (!shader.init())
+        return;
+
+    for (size_t begin = 0, end; begin < records.size(); begin = end)
+    {
+        const draw_record &first = records[begin];
+        for (end = begin + 1; end < records.size() && records[end].geometry == first.geometry && records[end].tex == first.tex; end++)
+            ;
+
+        // unlit meshes have no normals for the shader's lighting, they stay on fixed function
+        if (end - begin < RENDER_INSTANCING_MIN || !first.use_normals)
+            continue;
+
+        batches.push_back({begin, end, instances.size()});
+        for (size_t r = begin; r < end; r++)
+        {
+            const material &mat = materials[records[r].material_index];
+            instance_data instance;
+            std::memcpy(instance.world, (const float *)*records[r].world_matrix, sizeof(instance.world));
+
+            const vector3 *components[] = {&mat.diffuse, &mat.ambient, &mat.specular, &mat.emmissive};
+            float *destinations[] = {instance.diffuse, instance.ambient, instance.specular, instance.emission};
+            for (int c = 0; c < 4; c++)
+            {
+                destinations[c][0] = components[c]->x;
+                destinations[c][1] = components[c]->y;
+                destinations[c][2] = components[c]->z;
+                destinations[c][3] = 1.0f;
+            }
+            instance.ambient[3] = mat.shininess;
+
+            instances.push_back(instance);
+        }
+    }
+
+    if (instances.empty())
+        return;
+
+    if (!instance_buffer)
+        glGenBuffers(1, &instance_buffer);
+
+    // orphaned every frame, so the driver never waits for last frame's draws to finish reading it
+    size_t bytes = instances.size() * sizeof(instance_data);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+    if (bytes > instance_buffer_size)
+        instance_buffer_size = bytes * 2;
+    glBufferData(GL_ARRAY_BUFFER, instance_buffer_size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+}
+
+void render_queue::submit()
+{
+    const mesh *bound_mesh = nullptr;
+    bool bound_with_texture_coordinates = false;
+    int64_t applied_material = -1;
+    bool texturing = false;
+    const texture *bound_texture = nullptr;
+    bool texture_matrix_set = false;
+    bool instancing = false;
+    size_t next_batch = 0;
+    size_t texture_binds = texture::binds;
+
+    prepare_instances();
+
+    int light_count = 0;
+    while (light_count < INSTANCE_SHADER_MAX_LIGHTS && glIsEnabled(GL_LIGHT0 + light_count))
+        light_count++;
+
+    glDisable(GL_TEXTURE_2D);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    for (size_t r = 0; r < records.size(); r++)
+    {
+        const draw_record &record = records[r];
+        bool batched = next_batch < batches.size() && batches[next_batch].begin == r;
+
+        if (batched != instancing)
+        {
+            if (batched)
+                shader.begin(light_count);
+            else
+                shader.end();
+            instancing = batched;
+        }
+
+        bool textured = record.tex != nullptr;
+        if (textured != texturing)
+        {
+            if (textured)
+            {
+                glEnable(GL_TEXTURE_2D);
+                glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            }
+            else
+            {
+                glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+                glDisable(GL_TEXTURE_2D);
+            }
+            texturing = textured;
+        }
+
+        if (textured && record.tex != bound_texture)
+        {
+            record.tex->bind();
+            bound_texture = record.tex;
+
+            // atlased textures remap the mesh's coordinates onto their region of the page
+            if (record.tex->is_atlased())
+            {
+                const vector4 &uv_transform = record.tex->get_uv_transform();
+                glMatrixMode(GL_TEXTURE);
+                glLoadIdentity();
+                glTranslatef(uv_transform.z, uv_transform.w, 0.0f);
+                glScalef(uv_transform.x, uv_transform.y, 1.0f);
+                glMatrixMode(GL_MODELVIEW);
+                texture_matrix_set = true;
+            }
+            else if (texture_matrix_set)
+            {
+                glMatrixMode(GL_TEXTURE);
+                glLoadIdentity();
+                glMatrixMode(GL_MODELVIEW);
+                texture_matrix_set = false;
+            }
+        }
+
+        // instances carry their own material
+        if (!batched && record.use_normals && applied_material != record.material_index)
+        {
+            materials[record.material_index].apply_material();
+            applied_material = record.material_index;
+            state_changes++;
+        }
+
+        // a mesh bound without texture coordinates has no pointer for them, it must be bound again to get one
+        if (record.geometry != bound_mesh || (textured && !bound_with_texture_coordinates))
+        {
+            record.geometry->bind(record.use_normals, textured);
+            bound_mesh = record.geometry;
+            bound_with_texture_coordinates = textured;
+            state_changes++;
+        }
+
+        if (batched)
+        {
+            const instance_batch &batch = batches[next_batch++];
+            glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+            shader.set_instances(batch.first_instance);
+            shader.set_mesh(record.geometry->get_dequantization(), textured);
+            record.geometry->draw_instanced((GLsizei)(batch.end - batch.begin));
+
+            instanced += batch.end - batch.begin;
+            draws++;
+            r = batch.end - 1;
+            continue;
+        }
+
+        glPushMatrix();
+        glMultMatrixf(*record.world_matrix);
+        record.geometry->draw();
+        glPopMatrix();
+        draws++;
+    }
+
+    if (instancing)
+        shader.end();
+    if (texture_matrix_set)
+    {
+        glMatrixMode(GL_TEXTURE);
+        glLoadIdentity();
+        glMatrixMode(GL_MODELVIEW);
+    }
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+
+    state_changes += texture::binds - texture_binds;
+}
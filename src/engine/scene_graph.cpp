@@ -0,0 +1,390 @@
+#include "engine/scene_graph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+scene_graph::scene_graph(const std::vector<group> &roots)
+{
+    for (const group &root : roots)
+        append(root, -1);
+
+    // bake every matrix once, and find what can move
+    std::vector<unsigned char> moves(parents.size(), false);
+    for (size_t i = 0; i < parents.size(); i++)
+    {
+        compose_local(i);
+
+        int32_t parent = parents[i];
+        world_matrices[i] = parent < 0 ? local_matrices[i] : world_matrices[parent] * local_matrices[i];
+
+        moves[i] = animated[i] || (parent >= 0 && moves[parent]);
+        if (moves[i])
+            moving.push_back((uint32_t)i);
+    }
+
+    partition(0, (uint32_t)parents.size());
+
+    // moving groups change their own bounds, and with them every ancestor's
+    std::vector<unsigned char> rebounds(moves);
+    for (size_t i = parents.size(); i-- > 0;)
+    {
+        if (!rebounds[i])
+            continue;
+        rebound.push_back((uint32_t)i);
+        if (parents[i] >= 0)
+            rebounds[parents[i]] = true;
+    }
+
+    subtree_bounds.assign(parents.size(), vector4(0.0f, 0.0f, 0.0f, -1.0f));
+    sphere_xs.resize(models.size());
+    sphere_ys.resize(models.size());
+    sphere_zs.resize(models.size());
+    sphere_radii.resize(models.size());
+    refresh_bounds();
+}
+
+void scene_graph::append(const group &node, int32_t parent)
+{
+    uint32_t index = (uint32_t)parents.size();
+
+    parents.push_back(parent);
+    subtree_ends.push_back(index + 1);
+    transform_orders.push_back({node.transform_order[0], node.transform_order[1], node.transform_order[2]});
+    translations.push_back(node.t);
+    rotations.push_back(node.r);
+    scales.push_back(node.s);
+    local_matrices.push_back(node.model_matrix);
+    world_matrices.push_back(node.world_matrix);
+
+    model_begins.push_back((uint32_t)models.size());
+    models.insert(models.end(), node.models.begin(), node.models.end());
+    model_groups.insert(model_groups.end(), node.models.size(), index);
+    model_ends.push_back((uint32_t)models.size());
+    animated.push_back((node.t && node.t->is_animated()) || (node.r && node.r->is_animated()));
+
+    for (const group &sub : node.sub_groups)
+        append(sub, (int32_t)index);
+
+    subtree_ends[index] = (uint32_t)parents.size();
+}
+
+// render / update
+
+void scene_graph::partition(uint32_t first, uint32_t last)
+{
+    // runs of siblings are adjacent in moving too, so small ones are merged until they make a task worth running
+    uint32_t run_begin = first;
+    for (uint32_t i = first; i < last; i = subtree_ends[i])
+    {
+        if (moving_between(i, subtree_ends[i]) <= SCENE_GRAPH_TASK_GRAIN)
+        {
+            if (moving_between(run_begin, subtree_ends[i]) >= SCENE_GRAPH_TASK_GRAIN)
+            {
+                update_tasks.push_back({moving_between(0, run_begin), moving_between(0, subtree_ends[i])});
+                run_begin = subtree_ends[i];
+            }
+            continue;
+        }
+
+        if (moving_between(run_begin, i) > 0)
+            update_tasks.push_back({moving_between(0, run_begin), moving_between(0, i)});
+
+        // too big for one task: update the group itself first, then split its children
+        if (moving_between(i, i + 1) > 0)
+            serial_moving.push_back(i);
+        partition(i + 1, subtree_ends[i]);
+        run_begin = subtree_ends[i];
+    }
+
+    if (moving_between(run_begin, last) > 0)
+        update_tasks.push_back({moving_between(0, run_begin), moving_between(0, last)});
+}
+
+uint32_t scene_graph::moving_between(uint32_t first, uint32_t last) const
+{
+    return (uint32_t)(std::lower_bound(moving.begin(), moving.end(), last) - std::lower_bound(moving.begin(), moving.end(), first));
+}
+
+// render / update
+
+void scene_graph::update(int delta_time_ms)
+{
+    for (uint32_t i : moving)
+        update_group(i, delta_time_ms);
+
+    refresh_bounds();
+}
+
+void scene_graph::update(int delta_time_ms, work_stealing_pool &pool)
+{
+    if (update_tasks.size() < 2 || pool.get_thread_count() < 2)
+    {
+        update(delta_time_ms);
+        return;
+    }
+
+    for (uint32_t i : serial_moving)
+        update_group(i, delta_time_ms);
+
+    pool.run(update_tasks.size(), [this, delta_time_ms](size_t t) {
+        for (uint32_t m = update_tasks[t].begin; m < update_tasks[t].end; m++)
+            update_group(moving[m], delta_time_ms);
+    });
+
+    refresh_bounds();
+}
+
+void scene_graph::update_group(uint32_t index, int delta_time_ms)
+{
+    if (animated[index])
+    {
+        if (translations[index])
+            translations[index]->update(delta_time_ms);
+        if (rotations[index])
+            rotations[index]->update(delta_time_ms);
+        compose_local(index);
+    }
+
+    // parents come first, so theirs is already up to date
+    int32_t parent = parents[index];
+    world_matrices[index] = parent < 0 ? local_matrices[index] : world_matrices[parent] * local_matrices[index];
+}
+
+void scene_graph::compose_local(size_t index)
+{
+    matrix4x4 local = matrix4x4::Identity();
+    for (int o = 0; o < 3; o++)
+    {
+        unsigned char kind = transform_orders[index][o];
+        if (kind == 't')
+            local = local * *translations[index];
+        else if (kind == 'r')
+            local = local * *rotations[index];
+        else if (kind == 's')
+            local = local * scales[index];
+    }
+    local_matrices[index] = local;
+}
+
+void scene_graph::render(matrix4x4 &camera_transform, frustum &view_frustum, render_queue &queue, bool frustum_cull, bool render_bounding_spheres, bool draw_translation_path)
+{
+    queue.clear();
+    cull_planes.resize(parents.size());
+
+#ifndef IGNORE_FRUSTUM_CULL
+    bool use_index = frustum_cull && index.get_item_count() > 0;
+    bool test_spheres = frustum_cull;
+#else
+    bool use_index = false;
+    bool test_spheres = false;
+#endif
+
+    if (use_index)
+    {
+        visible.clear();
+        index.cull(view_frustum, visible);
+
+        // the survivors' spheres are scattered over the model arrays, gather them for one batch
+        size_t count = visible.size();
+        visible_xs.resize(count);
+        visible_ys.resize(count);
+        visible_zs.resize(count);
+        visible_radii.resize(count);
+        visible_planes.resize(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            uint32_t m = visible[k].item;
+            visible_xs[k] = sphere_xs[m];
+            visible_ys[k] = sphere_ys[m];
+            visible_zs[k] = sphere_zs[m];
+            visible_radii[k] = sphere_radii[m];
+            visible_planes[k] = visible[k].planes;
+        }
+        view_frustum.cull_spheres(visible_xs.data(), visible_ys.data(), visible_zs.data(), visible_radii.data(), count, visible_planes.data());
+
+        for (size_t k = 0; k < count; k++)
+        {
+            if (visible_planes[k] == FRUSTUM_CULLED)
+                continue;
+
+            uint32_t m = visible[k].item;
+            vector4 world_sphere(visible_xs[k], visible_ys[k], visible_zs[k], visible_radii[k]);
+            models[m].queue_model(view_frustum, true, visible_planes[k], world_matrices[model_groups[m]], world_sphere, render_bounding_spheres, camera_transform, queue);
+        }
+    }
+
+    // surviving groups next to each other own consecutive models, each run of them is culled in one batch
+    model_planes.resize(models.size());
+    uint32_t run_begin = 0, run_end = 0;
+    auto queue_run = [this, &view_frustum, frustum_cull, test_spheres, render_bounding_spheres, &camera_transform, &queue](uint32_t begin, uint32_t end) {
+        if (test_spheres)
+            view_frustum.cull_spheres(sphere_xs.data() + begin, sphere_ys.data() + begin, sphere_zs.data() + begin, sphere_radii.data() + begin, end - begin, model_planes.data() + begin);
+
+        for (uint32_t m = begin; m < end; m++)
+        {
+            if (model_planes[m] == FRUSTUM_CULLED)
+                continue;
+
+            vector4 world_sphere(sphere_xs[m], sphere_ys[m], sphere_zs[m], sphere_radii[m]);
+            models[m].queue_model(view_frustum, frustum_cull, model_planes[m], world_matrices[model_groups[m]], world_sphere, render_bounding_spheres, camera_transform, queue);
+        }
+    };
+
+    // empty subtrees stay empty, so that test still holds once the bvh took over the bounds
+    for (uint32_t i = 0; !use_index && i < parents.size();)
+    {
+        unsigned char planes = parents[i] < 0 ? FRUSTUM_ALL_PLANES : cull_planes[parents[i]];
+        const vector4 &bounds = subtree_bounds[i];
+
+        // nothing to draw anywhere below
+        if (bounds.w < 0)
+        {
+            i = subtree_ends[i];
+            continue;
+        }
+
+#ifndef IGNORE_FRUSTUM_CULL
+        // one test rejects the whole subtree, and planes it's entirely inside of are skipped by everything under it
+        if (frustum_cull && planes && !std::isinf(bounds.w) && !view_frustum.cull_sphere(vector3(bounds.x, bounds.y, bounds.z), bounds.w, planes))
+        {
+            i = subtree_ends[i];
+            continue;
+        }
+#endif
+        cull_planes[i] = planes;
+
+        // a rejected subtree with models in it ends the run
+        if (model_begins[i] != run_end)
+        {
+            queue_run(run_begin, run_end);
+            run_begin = model_begins[i];
+        }
+        std::fill(model_planes.begin() + model_begins[i], model_planes.begin() + model_ends[i], planes);
+        run_end = model_ends[i];
+        i++;
+    }
+    queue_run(run_begin, run_end);
+
+    // paths are in the parent's space, like the translation itself
+    for (size_t i = 0; draw_translation_path && i < parents.size(); i++)
+    {
+        if (!translations[i])
+            continue;
+
+        glDisable(GL_LIGHTING);
+        glPushMatrix();
+        if (parents[i] >= 0)
+            glMultMatrixf(world_matrices[parents[i]]);
+        translations[i]->draw_path();
+        glPopMatrix();
+        glEnable(GL_LIGHTING);
+    }
+
+    queue.sort();
+    queue.submit();
+}
+
+void scene_graph::refresh_bounds()
+{
+    // until every level of every mesh is resident any group's bounds can still grow, so all of them are recomputed
+    if (!bounds_complete)
+    {
+        bounds_complete = true;
+        for (size_t i = parents.size(); i-- > 0;)
+            bounds_complete = update_bounds((uint32_t)i) && bounds_complete;
+
+        if (bounds_complete && models.size() >= SCENE_GRAPH_BVH_MIN_MODELS)
+            build_index();
+        return;
+    }
+
+    if (index.get_item_count() == 0)
+    {
+        for (uint32_t i : rebound)
+            update_bounds(i);
+        return;
+    }
+
+    if (moving.empty())
+        return;
+
+    for (uint32_t i : moving)
+    {
+        for (uint32_t m = model_begins[i]; m < model_ends[i]; m++)
+        {
+            update_model_sphere(m, i);
+
+            bvh_box &bounds = index.item_bounds(m);
+            models[m].world_bounds(world_matrices[i], bounds.min, bounds.max);
+        }
+    }
+    index.refit();
+}
+
+void scene_graph::build_index()
+{
+    std::vector<bvh_box> boxes(models.size());
+    for (uint32_t m = 0; m < models.size(); m++)
+        models[m].world_bounds(world_matrices[model_groups[m]], boxes[m].min, boxes[m].max);
+
+    index.build(std::move(boxes));
+}
+
+bool scene_graph::update_bounds(uint32_t index)
+{
+    vector4 bounds(0.0f, 0.0f, 0.0f, -1.0f);
+    bool known = true, final = true;
+
+    for (uint32_t m = model_begins[index]; m < model_ends[index]; m++)
+    {
+        if (update_model_sphere(m, index))
+            math_utils::merge_spheres(bounds, vector4(sphere_xs[m], sphere_ys[m], sphere_zs[m], sphere_radii[m]));
+        else
+            known = false;
+
+        // a finer level still streaming in can grow the model's bounds
+        final = final && models[m].bounds_final();
+    }
+
+    for (uint32_t child = index + 1; child < subtree_ends[index]; child = subtree_ends[child])
+        math_utils::merge_spheres(bounds, subtree_bounds[child]);
+
+    // a model that isn't resident yet could be anywhere, never cull it
+    if (!known)
+        bounds.w = std::numeric_limits<float>::infinity();
+
+    subtree_bounds[index] = bounds;
+    return known && final;
+}
+
+bool scene_graph::update_model_sphere(uint32_t model_index, uint32_t group_index)
+{
+    vector4 sphere;
+    if (!models[model_index].world_bounding_sphere(world_matrices[group_index], sphere))
+    {
+        // never culled until it's resident
+        sphere_xs[model_index] = sphere_ys[model_index] = sphere_zs[model_index] = 0.0f;
+        sphere_radii[model_index] = std::numeric_limits<float>::infinity();
+        return false;
+    }
+
+    sphere_xs[model_index] = sphere.x;
+    sphere_ys[model_index] = sphere.y;
+    sphere_zs[model_index] = sphere.z;
+    sphere_radii[model_index] = sphere.w;
+    return true;
+}
+
+// getters
+
+std::vector<vector3> scene_graph::query_positions() const
+{
+    std::vector<vector3> positions;
+    positions.reserve(world_matrices.size());
+
+    for (const matrix4x4 &world : world_matrices)
+        positions.push_back(vector3(world.get_data_at_point(3, 0), world.get_data_at_point(3, 1), world.get_data_at_point(3, 2)));
+
+    return positions;
+}
@@ -0,0 +1,153 @@
+#include "engine/texture.hpp"
+
+size_t texture::binds = 0;
+std::atomic<uint32_t> texture::next_sort_id(0);
+
+namespace
+{
+    GLuint bound_id = 0; // < -- last texture bound through texture::bind or upload
+
+    std::mutex devil_mutex; // < -- DevIL binds images globally, only one decode at a time
+
+    // converts the bound image and builds its mip chain, devil_mutex must be held
+    bool decode_bound_image(ILuint image, bool loaded, texture_staging &staging)
+    {
+        if (!loaded || !ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE))
+        {
+            ilDeleteImages(1, &image);
+            return false;
+        }
+
+        texture_file::build_mip_chain(ilGetData(), ilGetInteger(IL_IMAGE_WIDTH), ilGetInteger(IL_IMAGE_HEIGHT), staging.decoded);
+        ilDeleteImages(1, &image);
+
+        staging.base = staging.decoded.pixels.data();
+        staging.levels = staging.decoded.levels;
+        return true;
+    }
+
+    // points the staging at the levels of a validated .3dt file
+    void use_cache(const unsigned char *data, const texture_file_header &header, texture_staging &staging)
+    {
+        staging.base = data;
+        staging.levels.assign(header.levels, header.levels + header.level_count);
+        staging.from_cache = true;
+    }
+}
+
+texture::~texture()
+{
+    // GL unbinds a deleted texture, and may hand its name out again
+    if (id != 0 && id == bound_id)
+        bound_id = 0;
+    glDeleteTextures(1, &id);
+}
+
+bool texture::read(const std::string &filepath, texture_staging &staging)
+{
+    std::string cache_path = texture_file::cache_path(filepath);
+    texture_source_info source;
+    std::string error;
+
+    if (staging.file.open(cache_path))
+    {
+        const texture_file_header *header = texture_file::read_header(staging.file.data(), staging.file.size(), error);
+        if (header && texture_file::is_up_to_date(*header, filepath, source))
+        {
+            use_cache(staging.file.data(), *header, staging);
+            return true;
+        }
+        staging.file.close();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(devil_mutex);
+
+        ILuint image;
+        ilGenImages(1, &image);
+        ilBindImage(image);
+
+        if (!decode_bound_image(image, ilLoadImage((ILstring)filepath.data()), staging))
+            return false;
+    }
+
+    // a failed write only costs the next run another decode
+    bool stamped = texture_file::stat_source(filepath, source) && texture_file::hash_source(filepath, source.hash);
+    if (!stamped || !texture_file::write(cache_path, staging.decoded, source))
+        printer::print_warning("Couldn't write mip cache " + cache_path, "texture");
+
+    return true;
+}
+
+bool texture::read(const unsigned char *data, size_t size, texture_staging &staging)
+{
+    std::string error;
+    const texture_file_header *header = texture_file::read_header(data, size, error);
+    if (header)
+    {
+        use_cache(data, *header, staging);
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(devil_mutex);
+
+    ILuint image;
+    ilGenImages(1, &image);
+    ilBindImage(image);
+
+    // older DevIL headers take a non-const lump, it's only read
+    return decode_bound_image(image, ilLoadL(IL_TYPE_UNKNOWN, const_cast<unsigned char *>(data), (ILuint)size), staging);
+}
+
+void texture::upload(const texture_staging &staging)
+{
+    width = staging.levels[0].width;
+    height = staging.levels[0].height;
+
+    glGenTextures(1, &id);
+
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+    // every level is precomputed, no glGenerateMipmap on the GL thread
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)staging.levels.size() - 1);
+
+    memory_size = 0;
+    for (size_t l = 0; l < staging.levels.size(); l++)
+    {
+        const texture_file_level &level = staging.levels[l];
+        glTexImage2D(GL_TEXTURE_2D, (GLint)l, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, staging.base + level.offset);
+        memory_size += (size_t)level.width * level.height * 4;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    bound_id = 0;
+
+    resident = true;
+}
+
+void texture::place(std::shared_ptr<texture> page, unsigned int width, unsigned int height, const vector4 &uv_transform)
+{
+    this->page = std::move(page);
+    this->width = width;
+    this->height = height;
+    this->uv_transform = uv_transform;
+    memory_size = 0; // accounted for by the page
+
+    resident = true;
+}
+
+void texture::bind() const
+{
+    GLuint target = get_id();
+    if (target == bound_id)
+        return;
+
+    glBindTexture(GL_TEXTURE_2D, target);
+    bound_id = target;
+    binds++;
+}
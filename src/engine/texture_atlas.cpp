@@ -0,0 +1,168 @@
+#include "engine/texture_atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    struct placement
+    {
+        size_t entry;
+        uint32_t x; // < -- bottom left corner of the texture itself, padding excluded
+        uint32_t y;
+    };
+
+    struct page_layout
+    {
+        skyline_packer packer{TEXTURE_ATLAS_PAGE_SIZE, TEXTURE_ATLAS_PAGE_SIZE};
+        std::vector<placement> placements;
+    };
+
+    // written by build before it queues its upload, read once everything is resident
+    size_t page_count = 0;
+    size_t atlased_count = 0;
+    size_t standalone_count = 0;
+    std::vector<float> page_occupancy;
+
+    void upload_standalone(const atlas_entry &entry)
+    {
+        std::shared_ptr<texture> target = entry.target;
+        std::shared_ptr<texture_staging> staging = entry.staging;
+        asset_loader::queue_upload([target, staging]() { target->upload(*staging); });
+    }
+
+    // copies a texture's base level into the page, repeating its edge texels over the padding around it
+    void blit_padded(const texture_staging &staging, uint32_t x, uint32_t y, unsigned char *page)
+    {
+        const texture_file_level &level = staging.levels[0];
+        const unsigned char *source = staging.base + level.offset;
+        int padding = TEXTURE_ATLAS_PADDING;
+
+        for (int row = -padding; row < (int)level.height + padding; row++)
+        {
+            int source_row = std::clamp(row, 0, (int)level.height - 1);
+            unsigned char *destination = page + ((size_t)(y + row) * TEXTURE_ATLAS_PAGE_SIZE + x) * 4;
+            const unsigned char *source_line = source + (size_t)source_row * level.width * 4;
+
+            for (int column = -padding; column < 0; column++)
+                std::memcpy(destination + column * 4, source_line, 4);
+            std::memcpy(destination, source_line, (size_t)level.width * 4);
+            for (int column = (int)level.width; column < (int)level.width + padding; column++)
+                std::memcpy(destination + column * 4, source_line + (level.width - 1) * 4, 4);
+        }
+    }
+}
+
+bool texture_atlas::is_candidate(const texture_staging &staging)
+{
+    return !staging.levels.empty() && staging.levels[0].width <= TEXTURE_ATLAS_MAX_SIZE && staging.levels[0].height <= TEXTURE_ATLAS_MAX_SIZE;
+}
+
+void texture_atlas::build(std::vector<atlas_entry> entries)
+{
+    if (entries.size() < 2)
+    {
+        for (const atlas_entry &entry : entries)
+            upload_standalone(entry);
+        standalone_count += entries.size();
+        return;
+    }
+
+    // tallest first keeps the skyline flat, which wastes less space under it
+    std::sort(entries.begin(), entries.end(), [](const atlas_entry &a, const atlas_entry &b) {
+        const texture_file_level &level_a = a.staging->levels[0], &level_b = b.staging->levels[0];
+        return level_a.height != level_b.height ? level_a.height > level_b.height : level_a.width > level_b.width;
+    });
+
+    std::vector<page_layout> layouts;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const texture_file_level &level = entries[i].staging->levels[0];
+        uint32_t padded_width = level.width + 2 * TEXTURE_ATLAS_PADDING;
+        uint32_t padded_height = level.height + 2 * TEXTURE_ATLAS_PADDING;
+
+        bool placed = false;
+        for (size_t p = 0; p <= layouts.size() && !placed; p++)
+        {
+            if (p == layouts.size())
+                layouts.emplace_back();
+
+            uint32_t x, y;
+            if (layouts[p].packer.insert(padded_width, padded_height, x, y))
+            {
+                layouts[p].placements.push_back({i, x + TEXTURE_ATLAS_PADDING, y + TEXTURE_ATLAS_PADDING});
+                placed = true;
+            }
+            else if (layouts[p].placements.empty())
+            {
+                layouts.pop_back(); // doesn't fit even an empty page
+                break;
+            }
+        }
+
+        if (!placed)
+        {
+            upload_standalone(entries[i]);
+            standalone_count++;
+        }
+    }
+
+    std::vector<std::shared_ptr<texture_staging>> pages;
+    for (const page_layout &layout : layouts)
+    {
+        std::vector<unsigned char> pixels((size_t)TEXTURE_ATLAS_PAGE_SIZE * TEXTURE_ATLAS_PAGE_SIZE * 4, 0);
+        for (const placement &placed : layout.placements)
+            blit_padded(*entries[placed.entry].staging, placed.x, placed.y, pixels.data());
+
+        std::shared_ptr<texture_staging> page = std::make_shared<texture_staging>();
+        texture_file::build_mip_chain(pixels.data(), TEXTURE_ATLAS_PAGE_SIZE, TEXTURE_ATLAS_PAGE_SIZE, page->decoded);
+        page->decoded.levels.resize(std::min(page->decoded.levels.size(), (size_t)TEXTURE_ATLAS_MAX_LEVEL + 1));
+        page->base = page->decoded.pixels.data();
+        page->levels = page->decoded.levels;
+        pages.push_back(page);
+
+        page_occupancy.push_back(layout.packer.get_occupancy());
+        atlased_count += layout.placements.size();
+    }
+    page_count += pages.size();
+
+    if (pages.empty())
+        return;
+
+    // the pages and every texture on them become resident together, in a single upload
+    asset_loader::queue_upload([entries, layouts, pages]() {
+        for (size_t p = 0; p < pages.size(); p++)
+        {
+            std::shared_ptr<texture> page = std::make_shared<texture>();
+            page->upload(*pages[p]);
+
+            for (const placement &placed : layouts[p].placements)
+            {
+                const texture_file_level &level = entries[placed.entry].staging->levels[0];
+                vector4 uv_transform((float)level.width / TEXTURE_ATLAS_PAGE_SIZE, (float)level.height / TEXTURE_ATLAS_PAGE_SIZE,
+                                     (float)placed.x / TEXTURE_ATLAS_PAGE_SIZE, (float)placed.y / TEXTURE_ATLAS_PAGE_SIZE);
+                entries[placed.entry].target->place(page, level.width, level.height, uv_transform);
+            }
+        }
+    });
+}
+
+void texture_atlas::print_stats()
+{
+    if (page_count == 0)
+        return;
+
+    std::stringstream ss;
+    for (size_t p = 0; p < page_occupancy.size(); p++)
+    {
+        ss.str(std::string());
+        ss << "Atlas page " << p << " (" << TEXTURE_ATLAS_PAGE_SIZE << "x" << TEXTURE_ATLAS_PAGE_SIZE << "): "
+           << (int)(page_occupancy[p] * 100.0f + 0.5f) << "% occupied";
+        printer::print_info(ss.str(), "texture_atlas");
+    }
+
+    ss.str(std::string());
+    ss << "Texture atlas: " << atlased_count << " texture(s) on " << page_count << " page(s), "
+       << standalone_count << " small texture(s) left on their own.";
+    printer::print_info(ss.str(), "texture_atlas");
+}
@@ -0,0 +1,174 @@
+#include "engine/texture_cache.hpp"
+
+namespace
+{
+    std::unordered_map<std::string, std::weak_ptr<texture>> textures;
+
+    size_t hits = 0;
+    size_t misses = 0;
+
+    std::atomic<size_t> cached_loads(0);  // < -- mip chains mapped from an up to date .3dt file
+    std::atomic<size_t> decoded_loads(0); // < -- images decoded and mipmapped on a worker
+
+    // textures requested while a config is loading are staged here and packed together once the last one is read
+    std::atomic<size_t> batch_reads(1);     // < -- reads in flight, plus one held until finish_requests
+    bool batch_open = true;                 // < -- GL thread only
+    std::mutex candidates_mutex;
+
+    struct atlas_candidate
+    {
+        atlas_entry entry;
+        std::shared_ptr<const bool> allowed; // < -- every request so far allowed atlasing
+    };
+    std::vector<atlas_candidate> atlas_candidates;
+
+    // written on the GL thread until finish_requests, only read by the atlas build that runs after it
+    std::unordered_map<std::string, std::shared_ptr<bool>> atlas_allowed;
+
+    // worker thread only
+    void build_atlas()
+    {
+        std::vector<atlas_candidate> candidates;
+        {
+            std::lock_guard<std::mutex> lock(candidates_mutex);
+            candidates.swap(atlas_candidates);
+        }
+
+        // a model that needs repeating texture coordinates may have asked for a texture after it was read
+        std::vector<atlas_entry> entries;
+        for (const atlas_candidate &candidate : candidates)
+        {
+            if (*candidate.allowed)
+            {
+                entries.push_back(candidate.entry);
+                continue;
+            }
+
+            std::shared_ptr<texture> target = candidate.entry.target;
+            std::shared_ptr<texture_staging> staging = candidate.entry.staging;
+            asset_loader::queue_upload([target, staging]() { target->upload(*staging); });
+        }
+        texture_atlas::build(std::move(entries));
+    }
+
+    std::string canonical_path(const std::string &filepath)
+    {
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::weakly_canonical(filepath, error);
+        if (error)
+            return filepath; // let the texture loader report the actual problem
+
+        return path.string();
+    }
+}
+
+std::shared_ptr<texture> texture_cache::acquire(const std::string &filepath, bool atlas)
+{
+    std::string key = canonical_path(filepath);
+
+    auto found = textures.find(key);
+    if (found != textures.end())
+    {
+        std::shared_ptr<texture> resident = found->second.lock();
+        if (resident)
+        {
+            hits++;
+
+            auto allowed = atlas_allowed.find(key);
+            if (batch_open && allowed != atlas_allowed.end())
+                *allowed->second = *allowed->second && atlas;
+            return resident;
+        }
+    }
+
+    misses++;
+    std::shared_ptr<texture> loaded = std::make_shared<texture>();
+    textures[key] = loaded;
+
+    bool batched = batch_open;
+    std::shared_ptr<bool> allowed = std::make_shared<bool>(atlas);
+    if (batched)
+    {
+        batch_reads++;
+        atlas_allowed[key] = allowed;
+    }
+
+    asset_loader::submit([loaded, filepath, batched, allowed]() {
+        std::shared_ptr<texture_staging> staging = std::make_shared<texture_staging>();
+        const unsigned char *packed;
+        size_t packed_size;
+        bool read = asset_loader::find_packed(filepath, packed, packed_size) ? texture::read(packed, packed_size, *staging) : texture::read(filepath, *staging);
+        if (!read)
+        {
+            printer::print_exception("Failed to load texture: " + filepath, "texture_cache");
+            if (batched && --batch_reads == 0)
+                build_atlas();
+            return; // never becomes resident, so models using it are never drawn
+        }
+        (staging->from_cache ? cached_loads : decoded_loads)++;
+
+        if (batched && texture_atlas::is_candidate(*staging))
+        {
+            std::lock_guard<std::mutex> lock(candidates_mutex);
+            atlas_candidates.push_back({{loaded, staging}, allowed});
+        }
+        else
+        {
+            // staging (and with it the decoded pixels) is released as soon as the upload has run
+            asset_loader::queue_upload([loaded, staging]() { loaded->upload(*staging); });
+        }
+
+        if (batched && --batch_reads == 0)
+            build_atlas();
+    });
+
+    return loaded;
+}
+
+void texture_cache::finish_requests()
+{
+    if (!batch_open)
+        return;
+    batch_open = false;
+
+    // the candidates keep their own references to the flags
+    atlas_allowed.clear();
+
+    // every read may be done already, then nobody else is left to build the atlas
+    if (--batch_reads == 0)
+        asset_loader::submit(build_atlas);
+}
+
+void texture_cache::print_stats()
+{
+    std::stringstream ss;
+    size_t resident_count = 0;
+    size_t resident_bytes = 0;
+
+    for (const auto &entry : textures)
+    {
+        std::shared_ptr<texture> resident = entry.second.lock();
+        if (!resident || !resident->is_resident())
+            continue;
+
+        resident_count++;
+        resident_bytes += resident->get_memory_size();
+
+        ss.str(std::string());
+        ss << entry.first << " (" << resident->get_width() << "x" << resident->get_height() << "): "
+           << resident->get_memory_size() / 1024 << " KiB";
+        printer::print_info(ss.str(), "texture_cache");
+    }
+
+    ss.str(std::string());
+    ss << "Texture cache: " << hits + misses << " request(s), " << hits << " hit(s), " << misses << " miss(es). "
+       << resident_count << " unique texture(s) resident using " << resident_bytes / 1024 << " KiB.";
+    printer::print_info(ss.str(), "texture_cache");
+
+    ss.str(std::string());
+    ss << "Mip cache: " << cached_loads << " texture(s) uploaded from " << TEXTURE_FILE_EXTENSION << " files, "
+       << decoded_loads << " decoded (cache written for next run).";
+    printer::print_info(ss.str(), "texture_cache");
+
+    texture_atlas::print_stats();
+}
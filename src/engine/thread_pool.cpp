@@ -0,0 +1,53 @@
+#include "engine/thread_pool.hpp"
+
+thread_pool::thread_pool(size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::thread::hardware_concurrency();
+    if (thread_count == 0)
+        thread_count = 1; // hardware_concurrency is allowed to not know
+
+    for (size_t i = 0; i < thread_count; i++)
+        workers.emplace_back(&thread_pool::worker_loop, this);
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        stopping = true;
+    }
+    tasks_available.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        tasks.push(std::move(task));
+    }
+    tasks_available.notify_one();
+}
+
+void thread_pool::worker_loop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasks_mutex);
+            tasks_available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+            if (tasks.empty())
+                return; // stopping and nothing left to do
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,118 @@
+#include "engine/work_stealing_pool.hpp"
+
+work_stealing_pool::work_stealing_pool(size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::thread::hardware_concurrency();
+    if (thread_count == 0)
+        thread_count = 1; // hardware_concurrency is allowed to not know
+
+    for (size_t i = 0; i < thread_count; i++)
+        queues.push_back(std::make_unique<task_queue>());
+
+    for (size_t i = 1; i < thread_count; i++)
+        workers.emplace_back(&work_stealing_pool::worker_loop, this, i);
+}
+
+work_stealing_pool::~work_stealing_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        stopping = true;
+    }
+    batch_started.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void work_stealing_pool::run(size_t task_count, const std::function<void(size_t)> &task)
+{
+    if (task_count == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        current = &task;
+        remaining = task_count;
+
+        // contiguous blocks, so neighbouring tasks (and whatever memory they share) stay on one thread unless stolen
+        for (size_t q = 0; q < queues.size(); q++)
+        {
+            std::lock_guard<std::mutex> queue_lock(queues[q]->mutex);
+            for (size_t t = task_count * q / queues.size(); t < task_count * (q + 1) / queues.size(); t++)
+                queues[q]->tasks.push_back(t);
+        }
+
+        batch++;
+    }
+    batch_started.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(batch_mutex);
+    batch_finished.wait(lock, [this]() { return remaining == 0; });
+    current = nullptr;
+}
+
+void work_stealing_pool::worker_loop(size_t index)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(batch_mutex);
+            batch_started.wait(lock, [this, seen]() { return stopping || batch != seen; });
+
+            if (stopping)
+                return;
+            seen = batch;
+        }
+
+        drain(index);
+    }
+}
+
+void work_stealing_pool::drain(size_t index)
+{
+    size_t task;
+    while (next_task(index, task))
+    {
+        (*current)(task);
+
+        if (--remaining == 0)
+        {
+            // taking the lock makes sure run is either not waiting yet or already waiting, never in between
+            std::lock_guard<std::mutex> lock(batch_mutex);
+            batch_finished.notify_all();
+        }
+    }
+}
+
+bool work_stealing_pool::next_task(size_t index, size_t &task)
+{
+    {
+        task_queue &own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); offset++)
+    {
+        task_queue &victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
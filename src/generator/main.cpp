@@ -17,6 +17,10 @@
 #include "generator/plane.hpp"
 #include "generator/torus.hpp"
 #include "generator/patch.hpp"
+#include "generator/optimize.hpp"
+#include "generator/simplify.hpp"
+#include "generator/pack.hpp"
+#include "generator/benchmark.hpp"
 
 #include "utils/printer.hpp"
 
@@ -35,6 +39,32 @@ int main(int argc, char **argv)
     SetConsoleMode(hOut, dwMode);
 #endif
 
+    // output switches can be anywhere in the argument list, strip them before the generators see them
+    model_file::format output_format = model_file::FORMAT_TEXT;
+    bool optimize = true;
+    int arg_count = 0;
+    for (int i = 0; i < argc; i++)
+    {
+        std::string arg(argv[i]);
+        if (arg.compare("--binary") == 0)
+            output_format = model_file::FORMAT_BINARY;
+        else if (arg.compare("--quantize") == 0)
+            output_format = model_file::FORMAT_QUANTIZED;
+        else if (arg.compare("--text") == 0)
+            output_format = model_file::FORMAT_TEXT;
+        else if (arg.compare("--no-optimize") == 0)
+            optimize = false;
+        else
+            argv[arg_count++] = argv[i];
+    }
+    argc = arg_count;
+
+    if (argc < 2)
+    {
+        printer::print_exception("Missing shape! Usage: generator [--binary | --quantize] [--no-optimize] <shape> <shape arguments...> <file.3d>");
+        return 1;
+    }
+
     shape_generator *generator;
 
     std::string model_type(argv[1]);
@@ -66,12 +96,31 @@ int main(int argc, char **argv)
     {
         generator = new patch_generator();
     }
+    else if (model_type.compare("optimize") == 0)
+    {
+        generator = new optimize_tool();
+    }
+    else if (model_type.compare("simplify") == 0)
+    {
+        generator = new simplify_tool();
+    }
+    else if (model_type.compare("pack") == 0)
+    {
+        generator = new pack_tool();
+    }
+    else if (model_type.compare("benchmark") == 0)
+    {
+        generator = new benchmark_tool();
+    }
     else
     {
         printer::print_exception("Invalid shape!");
         return 1;
     }
 
+    generator->set_output_format(output_format);
+    generator->set_optimize(optimize);
+
     try
     {
         generator->generate(argc, argv);
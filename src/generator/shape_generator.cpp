@@ -0,0 +1,69 @@
+#include "generator/shape_generator.hpp"
+
+void shape_generator::write_model(const std::string &filepath, const std::vector<vector3> &vertices, const std::vector<size_t> &indices, const std::vector<vector3> &normals, const std::vector<vector2> &tex_coords)
+{
+    mesh_data data;
+
+    data.vertices.reserve(vertices.size() * 3);
+    for (const vector3 &v : vertices)
+    {
+        data.vertices.push_back(v.x);
+        data.vertices.push_back(v.y);
+        data.vertices.push_back(v.z);
+    }
+
+    data.indices.reserve(indices.size());
+    for (size_t index : indices)
+    {
+        if (index > UINT32_MAX)
+            throw InvalidArgumentsException("Mesh has too many vertices to be indexed with 32 bit indices!");
+        data.indices.push_back((uint32_t)index);
+    }
+
+    data.normals.reserve(normals.size() * 3);
+    for (const vector3 &n : normals)
+    {
+        data.normals.push_back(n.x);
+        data.normals.push_back(n.y);
+        data.normals.push_back(n.z);
+    }
+
+    data.tex_coords.reserve(tex_coords.size() * 2);
+    for (const vector2 &t : tex_coords)
+    {
+        data.tex_coords.push_back(t.x);
+        data.tex_coords.push_back(t.y);
+    }
+
+    write_mesh(filepath, data);
+}
+
+void shape_generator::write_mesh(const std::string &filepath, mesh_data &data)
+{
+    if (optimize_output)
+    {
+        std::stringstream ss;
+        size_t vertex_count = data.vertex_count();
+        size_t removed = mesh_optimizer::weld(data);
+        ss << filepath << ": welded " << vertex_count << " -> " << data.vertex_count() << " vertices (" << removed << " duplicate(s) removed)";
+        printer::print_info(ss.str(), "optimize");
+
+        float acmr_before, acmr_after;
+        if (mesh_optimizer::optimize(data, acmr_before, acmr_after))
+        {
+            ss.str(std::string());
+            ss << filepath << ": ACMR " << acmr_before << " -> " << acmr_after;
+            printer::print_info(ss.str(), "optimize");
+        }
+    }
+
+    // generators don't know their exact extent (and edited meshes drift from it), so bounds always come from the vertices
+    model_file::compute_bounds(data);
+
+    if (!model_file::write(filepath, data, output_format))
+    {
+        std::stringstream ss;
+        ss << "Error opening output file " << filepath << "!";
+        throw InvalidArgumentsException(ss.str());
+    }
+}
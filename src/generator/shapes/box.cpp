@@ -21,12 +21,6 @@ void box_generator::generate(int argc, char **argv)
         throw InvalidArgumentsException("Invalid size or divisions!");
     }
 
-    std::ofstream file(filepath);
-    if (!file.is_open())
-    {
-        throw InvalidArgumentsException("Error opening the file!");
-    }
-
     std::vector<vector3> vertices;
     std::vector<size_t> indices;
 
@@ -110,43 +104,5 @@ void box_generator::generate(int argc, char **argv)
     addFace(-1, 0, 0, halfSize, -halfSize, halfSize, 0, 0, -step, 0, step, 0, true);
 
     // Escreve no ficheiro
-    file << "111\n"; // Placeholder de settings, pode ajustar se necessário
-
-    file << "0;0;0;" << (size * sqrtf(3)) / 2.0f << "\n";
-
-    // Escreve vértices
-    for (size_t i = 0; i < vertices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << vertices.at(i);
-    }
-    file << "\n";
-    // Escreve índices
-    for (size_t i = 0; i < indices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << indices.at(i);
-    }
-    file << "\n";
-
-    for (size_t i = 0; i < normals.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << normals.at(i);
-    }
-    file << "\n";
-
-    for (size_t i = 0; i < tex_coords.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << tex_coords.at(i);
-    }
-
-    file << std::flush;
-
-    file.close();
+    write_model(filepath, vertices, indices, normals, tex_coords);
 }
\ No newline at end of file
@@ -66,12 +66,6 @@ void cone_generator::generate(int argc, char **argv)
     // std::cout << "Stacks: " << stacks << std::endl;
     // std::cout << "Filepath: " << filepath << std::endl;
 
-    std::ofstream file(filepath);
-
-    if (!file.is_open())
-    {
-        throw InvalidArgumentsException("Error opening output file!");
-    }
 
     /*     std::vector<vector3> vertices;
         std::vector<size_t> indices;
@@ -327,50 +321,5 @@ void cone_generator::generate(int argc, char **argv)
     }
 
     // write to file
-
-    file << "111\n";
-
-    float bound_radius;
-    radius > height ? bound_radius = radius : bound_radius = height;
-
-    file << "0;0;0;" << bound_radius << "\n";
-
-    // vertices
-    for (size_t j = 0; j < vertices.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << vertices.at(j);
-    }
-    file << "\n";
-
-    // indices
-    for (size_t j = 0; j < indices.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << indices.at(j);
-    }
-    file << "\n";
-
-    // normals
-    for (size_t j = 0; j < normals.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << normals.at(j);
-    }
-    file << "\n";
-
-    // texture coordinates
-    for (size_t j = 0; j < tex_coords.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << tex_coords.at(j);
-    }
-
-    file << std::flush;
-
-    file.close();
+    write_model(filepath, vertices, indices, normals, tex_coords);
 }
\ No newline at end of file
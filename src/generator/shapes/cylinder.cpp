@@ -66,13 +66,6 @@ void cylinder_generator::generate(int argc, char **argv)
     // std::cout << "Stacks: " << stacks << std::endl;
     // std::cout << "Filepath: " << filepath << std::endl;
 
-    std::ofstream file(filepath);
-
-    if (!file.is_open())
-    {
-        throw InvalidArgumentsException("Error opening the file!");
-    }
-
     std::vector<vector3> vertices;
     std::vector<size_t> indices;
 
@@ -174,43 +167,6 @@ void cylinder_generator::generate(int argc, char **argv)
     }
 
     // write to file
-
-    // settings
-
     // always generating with indices, with no normals and no tex coords
-    file << "110\n";
-
-    float sphere_radius = sqrtf(radius * radius + (height / 2.0f) * (height / 2.0f));
-
-    file << "0;0;0;" << sphere_radius << "\n";
-
-    // vertices
-    for (size_t i = 0; i < vertices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << vertices.at(i);
-    }
-    file << "\n";
-
-    // indices
-    for (size_t i = 0; i < indices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << indices.at(i);
-    }
-    file << "\n";
-
-    // normals
-    for (size_t i = 0; i < normals.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << normals.at(i);
-    }
-
-    file << std::flush;
-
-    file.close();
+    write_model(filepath, vertices, indices, normals, std::vector<vector2>());
 }
\ No newline at end of file
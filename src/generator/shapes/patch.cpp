@@ -128,52 +128,7 @@ void patch_generator::generate(int argc, char **argv)
     }
 
     // write to file
-    std::ofstream output_file(output_filepath);
-
-    if (!output_file.is_open())
-    {
-        ss << "Failed to open output file at " << output_filepath << "!";
-        throw InvalidArgumentsException(ss.str());
-    }
-
-    // by this point the file should be open!
-    output_file << "111\n";
-
-    output_file << "0;0;0;" << 10.0f /*this is the bounding sphere radius, i'm not calculating it just yet*/ << "\n";
-
-    for (size_t i = 0; i < vertices.size(); i++)
-    {
-        if (i != 0)
-            output_file << ";";
-        output_file << vertices.at(i);
-    }
-    output_file << "\n";
-
-    for (size_t i = 0; i < mesh_indices.size(); i++)
-    {
-        if (i != 0)
-            output_file << ";";
-        output_file << mesh_indices.at(i);
-    }
-    output_file << "\n";
-
-    for (size_t i = 0; i < normals.size(); i++)
-    {
-        if (i != 0)
-            output_file << ";";
-        output_file << normals.at(i);
-    }
-    output_file << "\n";
-
-    for (size_t i = 0; i < tex_coords.size(); i++)
-    {
-        if (i != 0)
-            output_file << ";";
-        output_file << tex_coords.at(i);
-    }
-
-    output_file << std::flush;
-    output_file.close();
+    write_model(output_filepath, vertices, mesh_indices, normals, tex_coords);
 }
 
 void patch_generator::parse_file(const std::string &filepath)
@@ -21,12 +21,6 @@ void plane_generator::generate(int argc, char **argv)
         throw InvalidArgumentsException("Invalid length or divisions!");
     }
 
-    std::ofstream file(filepath);
-    if (!file.is_open())
-    {
-        throw InvalidArgumentsException("Error opening the file!");
-    }
-
     std::vector<vector3> vertices;
     std::vector<size_t> indices;
 
@@ -80,41 +74,5 @@ void plane_generator::generate(int argc, char **argv)
 
     addFace(0, 1, 0, -halfSize, -halfSize, -halfSize, step, 0, 0, 0, 0, step);
 
-    file << "111\n"; // Placeholder de settings, pode ajustar se necessário
-
-    file << "0;0;0;" << (length * sqrtf(2)) / 2.0f << "\n";
-
-    for (size_t i = 0; i < vertices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << vertices.at(i);
-    }
-    file << "\n";
-
-    for (size_t i = 0; i < indices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << indices.at(i);
-    }
-    file << "\n";
-
-    for (size_t i = 0; i < normals.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << normals.at(i);
-    }
-    file << "\n";
-
-    for (size_t i = 0; i < tex_coords.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << tex_coords.at(i);
-    }
-
-    file << std::flush;
-    file.close();
+    write_model(filepath, vertices, indices, normals, tex_coords);
 }
\ No newline at end of file
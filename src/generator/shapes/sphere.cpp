@@ -54,13 +54,6 @@ void sphere_generator::generate(int argc, char **argv)
     // std::cout << "Stacks: " << stacks << std::endl;
     // std::cout << "Filepath: " << filepath << std::endl;
 
-    std::ofstream file(filepath);
-
-    if (!file.is_open())
-    {
-        throw InvalidArgumentsException("Error opening the file!");
-    }
-
     std::vector<vector3> vertices;
     std::vector<size_t> indices;
 
@@ -170,49 +163,5 @@ void sphere_generator::generate(int argc, char **argv)
     }
 
     // write to file
-
-    // settings
-    file << "111\n";
-
-    file << "0;0;0;" << radius << "\n";
-
-    // vertices
-    for (size_t j = 0; j < vertices.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << vertices.at(j);
-    }
-    file << "\n";
-
-    // indices
-    for (size_t j = 0; j < indices.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << indices.at(j);
-    }
-    file << "\n";
-
-    // normals
-    for (size_t j = 0; j < normals.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << normals.at(j);
-    }
-
-    file << "\n";
-
-    // tex_coords
-    for (size_t j = 0; j < tex_coords.size(); j++)
-    {
-        if (j != 0)
-            file << ";";
-        file << tex_coords.at(j);
-    }
-
-    file << std::flush;
-
-    file.close();
+    write_model(filepath, vertices, indices, normals, tex_coords);
 }
\ No newline at end of file
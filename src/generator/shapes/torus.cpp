@@ -62,13 +62,6 @@ void torus_generator::generate(int argc, char **argv)
     if (n_sections < 3)
         throw InvalidArgumentsException("Number of sections must be larger than or equal to 3!");
 
-    std::ofstream file(filepath);
-
-    if (!file.is_open())
-    {
-        throw InvalidArgumentsException("Error opening the file!");
-    }
-
     std::vector<vector3> vertices;
     std::vector<size_t> indices;
 
@@ -151,44 +144,5 @@ void torus_generator::generate(int argc, char **argv)
     indices.push_back(n_sections - 1);
 
     // write to file
-    file << "111\n";
-
-    file << "0;0;0;" << center_radius + 2 * inner_radius << "\n";
-
-    // vertices
-    for (size_t i = 0; i < vertices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << vertices.at(i);
-    }
-    file << "\n";
-
-    // indices
-    for (size_t i = 0; i < indices.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << indices.at(i);
-    }
-    file << "\n";
-
-    for (size_t i = 0; i < normals.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << normals.at(i);
-    }
-    file << "\n";
-
-    for (size_t i = 0; i < tex_coords.size(); i++)
-    {
-        if (i != 0)
-            file << ";";
-        file << tex_coords.at(i);
-    }
-
-    file << std::flush;
-
-    file.close();
+    write_model(filepath, vertices, indices, normals, tex_coords);
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "generator/benchmark.hpp"
+
+namespace
+{
+    // the text loader as it was before model_file::parse_text, kept only as a baseline.
+    // line copies into a stringstream, token copies into strings, then stof/stoi.
+    void legacy_parse_text(const std::string &contents, mesh_data &out)
+    {
+        std::istringstream file(contents);
+        std::string line;
+        std::vector<char> data_order;
+        int line_index = 0;
+
+        out = mesh_data();
+
+        while (std::getline(file, line))
+        {
+            std::stringstream ss(line);
+            std::string token;
+
+            if (line_index == 0)
+            {
+                if (line[0] == '1')
+                    data_order.push_back('i');
+                if (line[1] == '1')
+                    data_order.push_back('n');
+                if (line[2] == '1')
+                    data_order.push_back('t');
+            }
+            else if (line_index == 1)
+            {
+                std::vector<float> bounding_sphere_info_vector;
+                while (std::getline(ss, token, ';'))
+                    bounding_sphere_info_vector.push_back(std::stof(token));
+
+                out.bounding_sphere = vector4(bounding_sphere_info_vector.at(0), bounding_sphere_info_vector.at(1), bounding_sphere_info_vector.at(2), bounding_sphere_info_vector.at(3));
+            }
+            else if (line_index == 2)
+            {
+                while (std::getline(ss, token, ';'))
+                    out.vertices.push_back(std::stof(token));
+            }
+            else
+            {
+                if (line_index - 3 >= (int)data_order.size())
+                    break;
+
+                char kind = data_order.at(line_index - 3);
+                while (std::getline(ss, token, ';'))
+                {
+                    if (kind == 'i')
+                        out.indices.push_back(std::stoi(token));
+                    else if (kind == 'n')
+                        out.normals.push_back(std::stof(token));
+                    else
+                        out.tex_coords.push_back(std::stof(token));
+                }
+            }
+
+            line_index++;
+        }
+    }
+}
+
+void benchmark_tool::generate(int argc, char **argv)
+{
+    if (argc < 3)
+        throw InvalidArgumentsException("Missing benchmark name! Available: parse, quantize, simplify");
+
+    std::string name(argv[2]);
+    if (name.compare("parse") == 0)
+        benchmark_parse(argc, argv);
+    else if (name.compare("quantize") == 0)
+        benchmark_quantize(argc, argv);
+    else if (name.compare("simplify") == 0)
+        benchmark_simplify(argc, argv);
+    else
+        throw InvalidArgumentsException("Unknown benchmark! Available: parse, quantize, simplify");
+}
+
+void benchmark_tool::benchmark_parse(int argc, char **argv)
+{
+    if (argc < 4)
+        throw InvalidArgumentsException("Usage: generator benchmark parse <file.3d> [file.3d ...]");
+
+    std::cout << std::left << std::setw(32) << "file" << std::right
+              << std::setw(12) << "size (KiB)" << std::setw(16) << "legacy (MB/s)" << std::setw(16) << "new (MB/s)" << std::setw(10) << "speedup" << "\n";
+
+    double total_bytes = 0, total_legacy = 0, total_new = 0;
+
+    for (int i = 3; i < argc; i++)
+    {
+        std::stringstream ss;
+        std::string filepath(argv[i]);
+
+        mapped_file file;
+        if (!file.open(filepath))
+        {
+            ss << "Couldn't open " << filepath << ", skipping.";
+            printer::print_warning(ss.str(), "benchmark parse");
+            continue;
+        }
+
+        if (model_file::is_binary(file.data(), file.size()))
+        {
+            ss << filepath << " is a binary .3d file, there's nothing to parse. Skipping.";
+            printer::print_warning(ss.str(), "benchmark parse");
+            continue;
+        }
+
+        const char *data = reinterpret_cast<const char *>(file.data());
+        std::string contents(data, file.size());
+
+        mesh_data legacy_result, new_result;
+        std::string error;
+
+        if (!model_file::parse_text(data, file.size(), new_result, error))
+        {
+            ss << filepath << ": " << error;
+            printer::print_warning(ss.str(), "benchmark parse");
+            continue;
+        }
+
+        double legacy_seconds = timing::time_runs([&]() { legacy_parse_text(contents, legacy_result); });
+        double new_seconds = timing::time_runs([&]() { model_file::parse_text(data, file.size(), new_result, error); });
+
+        if (legacy_result.vertices != new_result.vertices || legacy_result.indices != new_result.indices || legacy_result.normals != new_result.normals || legacy_result.tex_coords != new_result.tex_coords)
+        {
+            ss << filepath << ": parsers disagree on the file contents!";
+            printer::print_warning(ss.str(), "benchmark parse");
+        }
+
+        double megabytes = file.size() / 1.0e6;
+        total_bytes += megabytes;
+        total_legacy += legacy_seconds;
+        total_new += new_seconds;
+
+        std::cout << std::left << std::setw(32) << filepath << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << file.size() / 1024.0 << std::setw(16) << megabytes / legacy_seconds << std::setw(16) << megabytes / new_seconds
+                  << std::setw(9) << legacy_seconds / new_seconds << "x\n";
+    }
+
+    if (total_legacy > 0 && total_new > 0)
+    {
+        std::cout << std::left << std::setw(32) << "total" << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << total_bytes * 1.0e6 / 1024.0 << std::setw(16) << total_bytes / total_legacy << std::setw(16) << total_bytes / total_new
+                  << std::setw(9) << total_legacy / total_new << "x\n";
+    }
+
+    std::cout << std::flush;
+}
+
+void benchmark_tool::benchmark_quantize(int argc, char **argv)
+{
+    if (argc < 4)
+        throw InvalidArgumentsException("Usage: generator benchmark quantize <file.3d> [file.3d ...]");
+
+    std::string temp_path = (std::filesystem::temp_directory_path() / "benchmark_quantize.3d").string();
+
+    std::cout << std::left << std::setw(32) << "file" << std::right
+              << std::setw(12) << "float (KiB)" << std::setw(12) << "quant (KiB)" << std::setw(10) << "saved"
+              << std::setw(14) << "max pos err" << std::setw(12) << "(% extent)" << std::setw(14) << "max nrm (deg)" << std::setw(14) << "max uv err" << "\n";
+
+    for (int i = 3; i < argc; i++)
+    {
+        std::stringstream ss;
+        std::string filepath(argv[i]);
+
+        mesh_data original, quantized;
+        std::string error;
+        if (!model_file::read(filepath, original, error))
+        {
+            ss << filepath << ": " << error << " Skipping.";
+            printer::print_warning(ss.str(), "benchmark quantize");
+            continue;
+        }
+
+        if (!model_file::write_binary(temp_path, original, true) || !model_file::read(temp_path, quantized, error))
+            throw InvalidArgumentsException("Couldn't round trip through " + temp_path + "!");
+
+        double position_error = 0, extent = 0, normal_error = 0, uv_error = 0;
+        for (size_t v = 0; v < original.vertex_count(); v++)
+        {
+            double distance = 0;
+            const float center[3] = {(original.aabb_min.x + original.aabb_max.x) * 0.5f, (original.aabb_min.y + original.aabb_max.y) * 0.5f, (original.aabb_min.z + original.aabb_max.z) * 0.5f};
+            for (size_t c = 0; c < 3; c++)
+            {
+                double delta = original.vertices[v * 3 + c] - quantized.vertices[v * 3 + c];
+                distance += delta * delta;
+                extent = std::max(extent, (double)std::fabs(original.vertices[v * 3 + c] - center[c]));
+            }
+            position_error = std::max(position_error, std::sqrt(distance));
+
+            if (original.has_normals())
+            {
+                vector3 a(original.normals[v * 3], original.normals[v * 3 + 1], original.normals[v * 3 + 2]);
+                vector3 b(quantized.normals[v * 3], quantized.normals[v * 3 + 1], quantized.normals[v * 3 + 2]);
+                double lengths = std::sqrt((double)vector3::dot(a, a) * vector3::dot(b, b));
+                if (std::isfinite(lengths) && lengths > 0) // degenerate normals have no direction to lose
+                {
+                    double cosine = std::clamp(vector3::dot(a, b) / lengths, -1.0, 1.0);
+                    normal_error = std::max(normal_error, std::acos(cosine) * 180.0 / M_PI);
+                }
+            }
+
+            if (original.has_tex_coords())
+            {
+                for (size_t c = 0; c < 2; c++)
+                    uv_error = std::max(uv_error, (double)std::fabs(original.tex_coords[v * 2 + c] - quantized.tex_coords[v * 2 + c]));
+            }
+        }
+
+        // GPU memory as the engine uploads it: the vertex buffers plus the (shared) index buffer
+        size_t index_bytes = original.indices.size() * (original.can_use_short_indices() ? sizeof(uint16_t) : sizeof(uint32_t));
+        size_t float_bytes = (original.vertices.size() + original.normals.size() + original.tex_coords.size()) * sizeof(float) + index_bytes;
+        size_t quantized_bytes = original.vertex_count() * model_file::quantized_stride((original.has_normals() ? MODEL_FLAG_NORMALS : 0) | (original.has_tex_coords() ? MODEL_FLAG_TEXTURE_COORDINATES : 0)) + index_bytes;
+
+        std::cout << std::left << std::setw(32) << filepath << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << float_bytes / 1024.0 << std::setw(12) << quantized_bytes / 1024.0
+                  << std::setw(9) << 100.0 * (1.0 - (double)quantized_bytes / float_bytes) << "%"
+                  << std::scientific << std::setprecision(2) << std::setw(14) << position_error
+                  << std::fixed << std::setprecision(4) << std::setw(12) << (extent > 0 ? 100.0 * position_error / extent : 0.0)
+                  << std::setprecision(3) << std::setw(14) << normal_error
+                  << std::scientific << std::setprecision(2) << std::setw(14) << uv_error << "\n";
+    }
+
+    std::filesystem::remove(temp_path);
+    std::cout << std::defaultfloat << std::flush;
+}
+
+void benchmark_tool::benchmark_simplify(int argc, char **argv)
+{
+    if (argc < 4)
+        throw InvalidArgumentsException("Usage: generator benchmark simplify <file.3d> [ratio ...]");
+
+    std::string filepath(argv[3]);
+
+    std::vector<float> ratios;
+    for (int i = 4; i < argc; i++)
+    {
+        float ratio = (float)std::atof(argv[i]);
+        if (ratio <= 0 || ratio > 1)
+            throw InvalidArgumentsException("Ratios must be in ]0, 1]!");
+        ratios.push_back(ratio);
+    }
+    if (ratios.empty())
+        ratios = {0.5f, 0.25f, 0.1f, 0.05f, 0.01f};
+
+    mesh_data original;
+    std::string error;
+    if (!model_file::read(filepath, original, error))
+        throw InvalidArgumentsException(filepath + ": " + error);
+    mesh_optimizer::weld(original);
+
+    float diagonal = 0;
+    {
+        float low[3] = {original.vertices[0], original.vertices[1], original.vertices[2]};
+        float high[3] = {low[0], low[1], low[2]};
+        for (size_t v = 0; v < original.vertex_count(); v++)
+        {
+            for (size_t c = 0; c < 3; c++)
+            {
+                low[c] = std::min(low[c], original.vertices[v * 3 + c]);
+                high[c] = std::max(high[c], original.vertices[v * 3 + c]);
+            }
+        }
+        diagonal = std::sqrt((high[0] - low[0]) * (high[0] - low[0]) + (high[1] - low[1]) * (high[1] - low[1]) + (high[2] - low[2]) * (high[2] - low[2]));
+    }
+
+    std::cout << filepath << ": " << original.indices.size() / 3 << " triangles, " << original.vertex_count() << " vertices, bounding box diagonal " << diagonal << "\n";
+    std::cout << std::right << std::setw(8) << "ratio" << std::setw(14) << "triangles" << std::setw(12) << "time (s)"
+              << std::setw(14) << "hausdorff" << std::setw(14) << "(% diagonal)" << "\n";
+
+    for (float ratio : ratios)
+    {
+        mesh_data simplified = original;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        size_t remaining = mesh_simplifier::simplify(simplified, ratio);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        float hausdorff = mesh_simplifier::hausdorff_distance(original, simplified);
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(8) << ratio << std::setw(14) << remaining
+                  << std::setw(12) << seconds << std::scientific << std::setprecision(2) << std::setw(14) << hausdorff
+                  << std::fixed << std::setprecision(3) << std::setw(14) << 100.0f * hausdorff / diagonal << "\n";
+    }
+
+    std::cout << std::defaultfloat << std::flush;
+}
@@ -0,0 +1,22 @@
+#include "generator/optimize.hpp"
+
+void optimize_tool::generate(int argc, char **argv)
+{
+    if (argc != 4)
+        throw InvalidArgumentsException("Wrong number of arguments! Usage: generator optimize <in.3d> <out.3d>");
+
+    std::string input(argv[2]);
+    std::string output(argv[3]);
+
+    if (!validate_filepath(output))
+        throw InvalidArgumentsException("Output file must have the .3d extension!");
+
+    mesh_data data;
+    std::string error;
+    if (!model_file::read(input, data, error))
+        throw InvalidArgumentsException(input + ": " + error);
+
+    // write_mesh welds, runs the optimizer and prints vertex counts and ACMR before and after
+    set_optimize(true);
+    write_mesh(output, data);
+}
@@ -0,0 +1,75 @@
+#include "generator/pack.hpp"
+
+void pack_tool::generate(int argc, char **argv)
+{
+    if (argc != 4)
+        throw InvalidArgumentsException("Wrong number of arguments! Usage: generator pack <config.xml> <out.pack>");
+
+    std::string input(argv[2]);
+    std::string output(argv[3]);
+
+    if (!validate_filepath(output, ".pack"))
+        throw InvalidArgumentsException("Output file must have the .pack extension!");
+
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(input.c_str()) != tinyxml2::XML_SUCCESS || !doc.RootElement())
+        throw InvalidArgumentsException("Failed to load XML config file at: " + input);
+
+    // the config always goes first, the engine reads it from entry 0
+    std::vector<scene_pack_source> sources;
+    sources.push_back({input, input});
+
+    std::unordered_set<std::string> seen;
+    collect_assets(doc.RootElement(), sources, seen);
+
+    std::string error;
+    if (!scene_pack::write(output, sources, error))
+        throw InvalidArgumentsException(output + ": " + error);
+
+    scene_pack written;
+    if (!written.open(output, error))
+        throw InvalidArgumentsException(output + ": " + error);
+
+    std::stringstream ss;
+    ss << output << ": packed " << input << " and " << sources.size() - 1 << " asset(s), " << written.get_file_size() / 1024 << " KiB";
+    printer::print_info(ss.str(), "pack");
+}
+
+std::string pack_tool::cached_texture(const std::string &filepath)
+{
+    std::string cache_path = texture_file::cache_path(filepath);
+
+    mapped_file cache;
+    std::string error;
+    texture_source_info source;
+    if (!cache.open(cache_path))
+        return filepath;
+
+    const texture_file_header *header = texture_file::read_header(cache.data(), cache.size(), error);
+    if (!header || !texture_file::is_up_to_date(*header, filepath, source))
+        return filepath;
+
+    return cache_path;
+}
+
+void pack_tool::collect_assets(tinyxml2::XMLElement *root, std::vector<scene_pack_source> &sources, std::unordered_set<std::string> &seen)
+{
+    for (tinyxml2::XMLElement *child = root->FirstChildElement(); child; child = child->NextSiblingElement())
+    {
+        std::string tag = child->Name();
+        const char *filepath = child->Attribute("file");
+
+        // names are kept exactly as written, that's what the engine looks them up by
+        if (filepath && (tag == "model" || tag == "lod" || tag == "texture") && seen.insert(filepath).second)
+        {
+            // textures the engine has already decoded go in as their mip cache, so loading them needs no decode at all
+            std::string stored = filepath;
+            if (tag == "texture")
+                stored = cached_texture(filepath);
+
+            sources.push_back({filepath, stored});
+        }
+
+        collect_assets(child, sources, seen);
+    }
+}
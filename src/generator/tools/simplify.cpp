@@ -0,0 +1,46 @@
+#include "generator/simplify.hpp"
+
+void simplify_tool::generate(int argc, char **argv)
+{
+    if (argc != 5)
+        throw InvalidArgumentsException("Wrong number of arguments! Usage: generator simplify <in.3d> <target_ratio> <out.3d>");
+
+    std::string input(argv[2]);
+    std::string output(argv[4]);
+
+    float target_ratio;
+    try
+    {
+        target_ratio = std::stof(argv[3]);
+    }
+    catch (const std::exception &)
+    {
+        throw InvalidArgumentsException("Target ratio must be a number!");
+    }
+
+    // written so NaN fails it too
+    if (!(target_ratio > 0 && target_ratio <= 1))
+        throw InvalidArgumentsException("Target ratio must be in ]0, 1]!");
+
+    if (!validate_filepath(output))
+        throw InvalidArgumentsException("Output file must have the .3d extension!");
+
+    mesh_data data;
+    std::string error;
+    if (!model_file::read(input, data, error))
+        throw InvalidArgumentsException(input + ": " + error);
+
+    // collapses need connectivity, which needs shared vertices
+    mesh_optimizer::weld(data);
+
+    size_t triangle_count = data.indices.size() / 3;
+    size_t remaining = mesh_simplifier::simplify(data, target_ratio);
+
+    std::stringstream ss;
+    ss << input << ": " << triangle_count << " -> " << remaining << " triangles";
+    if (remaining > (size_t)std::ceil(triangle_count * target_ratio))
+        ss << " (stopped early, every remaining collapse would break a seam, a boundary or the surface)";
+    printer::print_info(ss.str(), "simplify");
+
+    write_mesh(output, data);
+}
@@ -1,5 +1,7 @@
 #include "math/math_utils.hpp"
 
+#include <cmath>
+
 namespace math_utils
 {
     vector3 point_on_bezier(float t, vector3 p0, vector3 p1, vector3 p2, vector3 p3)
@@ -39,4 +41,32 @@ namespace math_utils
 
         return deriv;
     }
-}
\ No newline at end of file
+
+    void merge_spheres(vector4 &into, const vector4 &sphere)
+    {
+        if (sphere.w < 0)
+            return;
+        if (into.w < 0 || std::isinf(sphere.w))
+        {
+            into = sphere;
+            return;
+        }
+        if (std::isinf(into.w))
+            return;
+
+        vector3 offset(sphere.x - into.x, sphere.y - into.y, sphere.z - into.z);
+        float distance = offset.magnitude();
+        if (distance + sphere.w <= into.w)
+            return;
+        if (distance + into.w <= sphere.w)
+        {
+            into = sphere;
+            return;
+        }
+
+        // smallest sphere touching both from the outside, distance can't be 0 here
+        float radius = (distance + into.w + sphere.w) * 0.5f;
+        float t = (radius - into.w) / distance;
+        into = vector4(into.x + offset.x * t, into.y + offset.y * t, into.z + offset.z * t, radius);
+    }
+}
@@ -253,7 +253,7 @@ matrix4x4 matrix4x4::Bezier()
 
 // getters
 
-float matrix4x4::get_data_at_point(int row, int column)
+float matrix4x4::get_data_at_point(int row, int column) const
 {
     return m_data[row * 4 + column];
 }
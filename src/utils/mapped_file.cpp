@@ -0,0 +1,134 @@
+#include "utils/mapped_file.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+{
+    steal(other);
+}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        steal(other);
+    }
+    return *this;
+}
+
+void mapped_file::steal(mapped_file &other)
+{
+    mapped_data = other.mapped_data;
+    mapped_size = other.mapped_size;
+    other.mapped_data = nullptr;
+    other.mapped_size = 0;
+
+#ifdef _WIN32
+    file_handle = other.file_handle;
+    mapping_handle = other.mapping_handle;
+    other.file_handle = INVALID_HANDLE_VALUE;
+    other.mapping_handle = NULL;
+#endif
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const std::string &filepath)
+{
+    close();
+
+    file_handle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+
+    mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_handle == NULL)
+    {
+        close();
+        return false;
+    }
+
+    void *view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL)
+    {
+        close();
+        return false;
+    }
+
+    mapped_data = static_cast<const unsigned char *>(view);
+    mapped_size = (size_t)file_size.QuadPart;
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (mapped_data)
+        UnmapViewOfFile(mapped_data);
+    if (mapping_handle != NULL)
+        CloseHandle(mapping_handle);
+    if (file_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(file_handle);
+
+    mapped_data = nullptr;
+    mapped_size = 0;
+    mapping_handle = NULL;
+    file_handle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool mapped_file::open(const std::string &filepath)
+{
+    close();
+
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *view = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if (view == MAP_FAILED)
+        return false;
+
+    madvise(view, (size_t)file_stat.st_size, MADV_WILLNEED);
+
+    mapped_data = static_cast<const unsigned char *>(view);
+    mapped_size = (size_t)file_stat.st_size;
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (mapped_data)
+        munmap(const_cast<unsigned char *>(mapped_data), mapped_size);
+
+    mapped_data = nullptr;
+    mapped_size = 0;
+}
+
+#endif
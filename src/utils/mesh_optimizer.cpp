@@ -0,0 +1,292 @@
+#include "utils/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+    // Forsyth scoring constants, as in the original write-up
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    float vertex_score(int cache_position, uint32_t remaining_triangles)
+    {
+        if (remaining_triangles == 0)
+            return -1.0f; // nothing left to draw with this vertex
+
+        float score = 0.0f;
+        if (cache_position >= 0)
+        {
+            if (cache_position < 3)
+                score = LAST_TRIANGLE_SCORE; // used by the last triangle, fixed score so the strip doesn't just bounce around
+            else
+                score = std::pow(1.0f - (float)(cache_position - 3) / (VERTEX_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+
+        // favour vertices with few triangles left, so they get finished off and stop cluttering the cache
+        score += VALENCE_BOOST_SCALE * std::pow((float)remaining_triangles, -VALENCE_BOOST_POWER);
+        return score;
+    }
+
+    // every attribute of a vertex snapped to the weld grid: position xyz, normal xyz, uv
+    typedef std::array<int64_t, 8> weld_key;
+
+    struct weld_key_hash
+    {
+        size_t operator()(const weld_key &key) const
+        {
+            uint64_t hash = 14695981039346656037ull; // FNV-1a over the snapped values
+            for (int64_t value : key)
+            {
+                hash ^= (uint64_t)value;
+                hash *= 1099511628211ull;
+            }
+            return (size_t)hash;
+        }
+    };
+
+    int64_t snap(float value, float tolerance)
+    {
+        if (!std::isfinite(value))
+            return INT64_MIN; // degenerate normals end up as NaN, weld them together instead of keeping them all
+        return (int64_t)std::llround(value / tolerance);
+    }
+
+    void remap_attribute(std::vector<float> &attribute, size_t components, const std::vector<uint32_t> &remap, size_t new_count)
+    {
+        if (attribute.empty())
+            return;
+
+        std::vector<float> reordered(new_count * components);
+        for (size_t old_index = 0; old_index < remap.size(); old_index++)
+        {
+            if (remap[old_index] == UINT32_MAX)
+                continue;
+
+            std::copy_n(&attribute[old_index * components], components, &reordered[remap[old_index] * components]);
+        }
+
+        attribute.swap(reordered);
+    }
+}
+
+size_t mesh_optimizer::weld(mesh_data &data, float tolerance)
+{
+    size_t vertex_count = data.vertex_count();
+
+    if (!data.has_indices())
+    {
+        data.indices.resize(vertex_count);
+        for (size_t i = 0; i < vertex_count; i++)
+            data.indices[i] = (uint32_t)i;
+    }
+
+    std::unordered_map<weld_key, uint32_t, weld_key_hash> unique;
+    unique.reserve(vertex_count);
+
+    std::vector<uint32_t> remap(vertex_count, UINT32_MAX);
+    std::vector<uint32_t> first_of(vertex_count); // < -- original vertex each merged vertex is copied from
+    uint32_t next = 0;
+
+    for (size_t i = 0; i < vertex_count; i++)
+    {
+        weld_key key;
+        key.fill(0);
+        for (size_t c = 0; c < 3; c++)
+            key[c] = snap(data.vertices[i * 3 + c], tolerance);
+        if (data.has_normals())
+            for (size_t c = 0; c < 3; c++)
+                key[3 + c] = snap(data.normals[i * 3 + c], tolerance);
+        if (data.has_tex_coords())
+            for (size_t c = 0; c < 2; c++)
+                key[6 + c] = snap(data.tex_coords[i * 2 + c], tolerance);
+
+        auto inserted = unique.emplace(key, next);
+        if (inserted.second)
+            first_of[next++] = (uint32_t)i;
+        remap[i] = inserted.first->second;
+    }
+
+    for (uint32_t &index : data.indices)
+        index = remap[index];
+
+    // keep the first vertex of every merged group
+    std::vector<uint32_t> keep(vertex_count, UINT32_MAX);
+    for (uint32_t v = 0; v < next; v++)
+        keep[first_of[v]] = v;
+
+    remap_attribute(data.vertices, 3, keep, next);
+    remap_attribute(data.normals, 3, keep, next);
+    remap_attribute(data.tex_coords, 2, keep, next);
+
+    return vertex_count - next;
+}
+
+float mesh_optimizer::compute_acmr(const std::vector<uint32_t> &indices, size_t vertex_count, size_t cache_size)
+{
+    if (indices.size() < 3)
+        return 0.0f;
+
+    // time stamp of when each vertex entered the FIFO, a vertex is cached while it's within cache_size misses
+    std::vector<size_t> entered(vertex_count, 0);
+    size_t misses = 0;
+
+    for (uint32_t index : indices)
+    {
+        if (entered[index] == 0 || misses - entered[index] >= cache_size)
+        {
+            misses++;
+            entered[index] = misses;
+        }
+    }
+
+    return (float)misses / (indices.size() / 3);
+}
+
+void mesh_optimizer::optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count)
+{
+    size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+        return;
+
+    // triangles adjacent to each vertex, packed per vertex (offsets into adjacency)
+    std::vector<uint32_t> remaining(vertex_count, 0);
+    for (uint32_t index : indices)
+        remaining[index]++;
+
+    std::vector<uint32_t> offsets(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; v++)
+        offsets[v + 1] = offsets[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangle_count; t++)
+            for (size_t k = 0; k < 3; k++)
+                adjacency[fill[indices[t * 3 + k]]++] = (uint32_t)t;
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> score(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++)
+        score[v] = vertex_score(-1, remaining[v]);
+
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    for (size_t t = 0; t < triangle_count; t++)
+        triangle_score[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+
+    std::vector<uint32_t> cache, next_cache;
+    cache.reserve(VERTEX_CACHE_SIZE + 3);
+    next_cache.reserve(VERTEX_CACHE_SIZE + 3);
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    size_t scan_cursor = 0; // < -- every triangle before this one has been emitted
+    long best = -1;
+
+    while (result.size() < indices.size())
+    {
+        if (best < 0)
+        {
+            // dead end, nothing in the cache has triangles left: restart from the first triangle not emitted
+            while (emitted[scan_cursor])
+                scan_cursor++;
+            best = (long)scan_cursor;
+        }
+
+        const uint32_t *triangle = &indices[best * 3];
+        emitted[best] = true;
+        result.insert(result.end(), triangle, triangle + 3);
+
+        // remove the triangle from its vertices' adjacency
+        for (size_t k = 0; k < 3; k++)
+        {
+            uint32_t v = triangle[k];
+            uint32_t *begin = &adjacency[offsets[v]];
+            uint32_t *end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, (uint32_t)best), end - 1);
+            remaining[v]--;
+        }
+
+        // the triangle's vertices go to the front of the LRU cache
+        next_cache.assign(triangle, triangle + 3);
+        for (uint32_t v : cache)
+        {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                next_cache.push_back(v);
+        }
+
+        for (size_t i = 0; i < next_cache.size(); i++)
+            cache_position[next_cache[i]] = i < VERTEX_CACHE_SIZE ? (int)i : -1;
+
+        // rescore everything that was in the cache, evicted vertices included
+        for (uint32_t v : next_cache)
+            score[v] = vertex_score(cache_position[v], remaining[v]);
+
+        if (next_cache.size() > VERTEX_CACHE_SIZE)
+            next_cache.resize(VERTEX_CACHE_SIZE);
+        cache.swap(next_cache);
+
+        // the next triangle is the best one touching the cache
+        best = -1;
+        float best_score = -1.0f;
+        for (uint32_t v : cache)
+        {
+            for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++)
+            {
+                uint32_t t = adjacency[a];
+                triangle_score[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+                if (triangle_score[t] > best_score)
+                {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+void mesh_optimizer::optimize_vertex_fetch(mesh_data &data)
+{
+    size_t vertex_count = data.vertex_count();
+    std::vector<uint32_t> remap(vertex_count, UINT32_MAX);
+
+    uint32_t next = 0;
+    for (uint32_t &index : data.indices)
+    {
+        if (remap[index] == UINT32_MAX)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    remap_attribute(data.vertices, 3, remap, next);
+    remap_attribute(data.normals, 3, remap, next);
+    remap_attribute(data.tex_coords, 2, remap, next);
+}
+
+bool mesh_optimizer::optimize(mesh_data &data, float &acmr_before, float &acmr_after)
+{
+    if (!data.has_indices())
+        return false;
+
+    acmr_before = compute_acmr(data.indices, data.vertex_count());
+
+    // the greedy reordering can lose to an already good order on tiny meshes, keep whichever is better
+    std::vector<uint32_t> reordered = data.indices;
+    optimize_vertex_cache(reordered, data.vertex_count());
+    if (compute_acmr(reordered, data.vertex_count()) < acmr_before)
+        data.indices.swap(reordered);
+
+    optimize_vertex_fetch(data);
+
+    acmr_after = compute_acmr(data.indices, data.vertex_count());
+    return true;
+}
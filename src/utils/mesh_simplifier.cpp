@@ -0,0 +1,652 @@
+#include "utils/mesh_simplifier.hpp"
+#include "utils/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    // symmetric 4x4 error quadric, upper triangle only
+    struct quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+
+        void add_plane(double a, double b, double c, double d, double weight)
+        {
+            a2 += weight * a * a;
+            ab += weight * a * b;
+            ac += weight * a * c;
+            ad += weight * a * d;
+            b2 += weight * b * b;
+            bc += weight * b * c;
+            bd += weight * b * d;
+            c2 += weight * c * c;
+            cd += weight * c * d;
+            d2 += weight * d * d;
+        }
+
+        void add(const quadric &other)
+        {
+            a2 += other.a2;
+            ab += other.ab;
+            ac += other.ac;
+            ad += other.ad;
+            b2 += other.b2;
+            bc += other.bc;
+            bd += other.bd;
+            c2 += other.c2;
+            cd += other.cd;
+            d2 += other.d2;
+        }
+
+        // v^T Q v with v = (x, y, z, 1)
+        double evaluate(const float *p) const
+        {
+            double x = p[0], y = p[1], z = p[2];
+            return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                 + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                 + c2 * z * z + 2 * cd * z
+                 + d2;
+        }
+    };
+
+    struct collapse
+    {
+        float cost;
+        uint32_t from, to;
+        uint32_t stamp; // < -- version[from] when queued
+
+        bool operator>(const collapse &other) const { return cost > other.cost; }
+    };
+
+    void triangle_normal(const float *a, const float *b, const float *c, double *normal)
+    {
+        double e1[3] = {(double)b[0] - a[0], (double)b[1] - a[1], (double)b[2] - a[2]};
+        double e2[3] = {(double)c[0] - a[0], (double)c[1] - a[1], (double)c[2] - a[2]};
+        normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    }
+
+    uint64_t position_bits(const float *p)
+    {
+        uint32_t bits[3];
+        std::memcpy(bits, p, sizeof(bits));
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t b : bits)
+        {
+            hash ^= b;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    class simplifier
+    {
+    public:
+        simplifier(mesh_data &data) : data(data), positions(data.vertices.data())
+        {
+            vertex_count = data.vertex_count();
+            triangle_count = data.indices.size() / 3;
+        }
+
+        size_t run(size_t target_triangles)
+        {
+            build_adjacency();
+            lock_seams_and_boundaries();
+            build_quadrics();
+
+            // one entry per vertex (its cheapest collapse) keeps the heap at vertex count instead of edge count, built in one go
+            std::vector<collapse> initial;
+            initial.reserve(vertex_count);
+            collapse best;
+            for (uint32_t v = 0; v < vertex_count; v++)
+                if (cheapest_collapse(v, best))
+                {
+                    initial.push_back(best);
+                    queued[v] = best;
+                }
+            heap = decltype(heap)(std::greater<collapse>(), std::move(initial));
+
+            size_t live_triangles = triangle_count;
+            while (live_triangles > target_triangles && !heap.empty())
+            {
+                collapse top = heap.top();
+                heap.pop();
+
+                if (version[top.from] != top.stamp)
+                    continue; // stale, a newer entry exists (or the vertex is gone)
+                version[top.from]++; // < -- no longer queued
+
+                // a rejected vertex waits until its neighbourhood changes and it gets a fresh entry
+                if (!can_collapse(top.from, top.to))
+                    continue;
+
+                live_triangles -= perform(top.from, top.to);
+            }
+
+            // compact
+            std::vector<uint32_t> indices;
+            indices.reserve(live_triangles * 3);
+            for (uint32_t t = 0; t < triangle_count; t++)
+            {
+                if (triangle_alive[t])
+                    indices.insert(indices.end(), &data.indices[t * 3], &data.indices[t * 3] + 3);
+            }
+            data.indices.swap(indices);
+
+            return live_triangles;
+        }
+
+    private:
+        mesh_data &data;
+        const float *positions;
+        size_t vertex_count;
+        size_t triangle_count;
+
+        std::vector<std::vector<uint32_t>> vertex_triangles;
+        std::vector<bool> triangle_alive;
+        std::vector<bool> locked;
+        std::vector<uint32_t> version;
+        std::vector<collapse> queued; // < -- last entry pushed per vertex, live while its stamp matches version
+        std::vector<quadric> quadrics;
+
+        std::priority_queue<collapse, std::vector<collapse>, std::greater<collapse>> heap;
+
+        std::vector<uint32_t> scratch_from, scratch_to; // < -- neighbour sets for the link condition
+
+        const float *position(uint32_t v) const { return positions + v * 3; }
+
+        void build_adjacency()
+        {
+            vertex_triangles.assign(vertex_count, {});
+            std::vector<uint32_t> valence(vertex_count, 0);
+            for (uint32_t index : data.indices)
+                valence[index]++;
+            for (size_t v = 0; v < vertex_count; v++)
+                vertex_triangles[v].reserve(valence[v]);
+
+            for (uint32_t t = 0; t < triangle_count; t++)
+                for (size_t k = 0; k < 3; k++)
+                    vertex_triangles[data.indices[t * 3 + k]].push_back(t);
+
+            triangle_alive.assign(triangle_count, true);
+            version.assign(vertex_count, 0);
+            queued.assign(vertex_count, {0, 0, 0, std::numeric_limits<uint32_t>::max()});
+        }
+
+        void lock_seams_and_boundaries()
+        {
+            locked.assign(vertex_count, false);
+
+            // vertices sharing a position but not every attribute sit on a uv or normal seam
+            std::unordered_map<uint64_t, uint32_t> first_at_position;
+            first_at_position.reserve(vertex_count);
+            std::vector<uint32_t> position_id(vertex_count);
+            for (uint32_t v = 0; v < vertex_count; v++)
+            {
+                auto inserted = first_at_position.emplace(position_bits(position(v)), v);
+                position_id[v] = inserted.first->second;
+                if (!inserted.second)
+                    locked[v] = locked[inserted.first->second] = true;
+            }
+
+            // edges used by a single triangle (by position, so seams don't count as boundaries) are open boundaries
+            std::vector<uint64_t> edges;
+            edges.reserve(triangle_count * 3);
+            for (size_t t = 0; t < triangle_count; t++)
+            {
+                for (size_t k = 0; k < 3; k++)
+                {
+                    uint32_t a = position_id[data.indices[t * 3 + k]];
+                    uint32_t b = position_id[data.indices[t * 3 + (k + 1) % 3]];
+                    edges.push_back(((uint64_t)std::min(a, b) << 32) | std::max(a, b));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+
+            for (size_t i = 0; i < edges.size();)
+            {
+                size_t j = i;
+                while (j < edges.size() && edges[j] == edges[i])
+                    j++;
+
+                if (j - i == 1)
+                {
+                    uint32_t a = (uint32_t)(edges[i] >> 32), b = (uint32_t)edges[i];
+                    locked[a] = locked[b] = true;
+                }
+                i = j;
+            }
+
+            // propagate to every vertex at a locked position
+            for (uint32_t v = 0; v < vertex_count; v++)
+                if (locked[position_id[v]])
+                    locked[v] = true;
+        }
+
+        void build_quadrics()
+        {
+            quadrics.assign(vertex_count, quadric());
+            for (size_t t = 0; t < triangle_count; t++)
+            {
+                const uint32_t *tri = &data.indices[t * 3];
+                double normal[3];
+                triangle_normal(position(tri[0]), position(tri[1]), position(tri[2]), normal);
+
+                double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                if (length == 0)
+                    continue;
+
+                double a = normal[0] / length, b = normal[1] / length, c = normal[2] / length;
+                const float *p = position(tri[0]);
+                double d = -(a * p[0] + b * p[1] + c * p[2]);
+
+                // area weighted, so big flat triangles resist more than slivers
+                quadric q;
+                q.add_plane(a, b, c, d, length * 0.5);
+                for (size_t k = 0; k < 3; k++)
+                    quadrics[tri[k]].add(q);
+            }
+        }
+
+        // cost of moving from onto to, i.e. the error of both quadrics at to's position
+        double collapse_cost(uint32_t from, uint32_t to) const
+        {
+            return quadrics[from].evaluate(position(to)) + quadrics[to].evaluate(position(to));
+        }
+
+        bool cheapest_collapse(uint32_t v, collapse &out) const
+        {
+            if (locked[v])
+                return false;
+
+            double best_cost = std::numeric_limits<double>::max();
+            uint32_t best_target = v;
+            for (uint32_t t : vertex_triangles[v])
+            {
+                if (!triangle_alive[t])
+                    continue;
+
+                const uint32_t *tri = &data.indices[t * 3];
+                for (size_t k = 0; k < 3; k++)
+                {
+                    if (tri[k] == v)
+                        continue;
+                    double cost = collapse_cost(v, tri[k]);
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_target = tri[k];
+                    }
+                }
+            }
+
+            if (best_target == v)
+                return false;
+
+            out = {(float)best_cost, v, best_target, version[v]};
+            return true;
+        }
+
+        void requeue(uint32_t v)
+        {
+            collapse best;
+            bool found = cheapest_collapse(v, best);
+
+            // most neighbours keep the same cheapest collapse, don't flood the heap with copies of it
+            const collapse &current = queued[v];
+            if (found && current.stamp == version[v] && current.to == best.to && current.cost == best.cost)
+                return;
+
+            version[v]++;
+            if (found)
+            {
+                best.stamp = version[v];
+                heap.push(best);
+                queued[v] = best;
+            }
+        }
+
+        void collect_neighbours(uint32_t v, std::vector<uint32_t> &out)
+        {
+            out.clear();
+            for (uint32_t t : vertex_triangles[v])
+            {
+                if (!triangle_alive[t])
+                    continue;
+                for (size_t k = 0; k < 3; k++)
+                    if (data.indices[t * 3 + k] != v)
+                        out.push_back(data.indices[t * 3 + k]);
+            }
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
+        }
+
+        bool can_collapse(uint32_t from, uint32_t to)
+        {
+            size_t shared_triangles = 0;
+            for (uint32_t t : vertex_triangles[from])
+            {
+                if (!triangle_alive[t])
+                    continue;
+
+                const uint32_t *tri = &data.indices[t * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                {
+                    shared_triangles++;
+                    continue;
+                }
+
+                // the triangle survives with to in place of from, it must not flip or degenerate
+                const float *before[3], *after[3];
+                for (size_t k = 0; k < 3; k++)
+                {
+                    before[k] = position(tri[k]);
+                    after[k] = tri[k] == from ? position(to) : before[k];
+                }
+
+                double n0[3], n1[3];
+                triangle_normal(before[0], before[1], before[2], n0);
+                triangle_normal(after[0], after[1], after[2], n1);
+
+                double l0 = std::sqrt(n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]);
+                double l1 = std::sqrt(n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]);
+                if (l1 <= 1e-12 || (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2]) < SIMPLIFY_MIN_NORMAL_DOT * l0 * l1)
+                    return false;
+            }
+
+            if (shared_triangles == 0)
+                return false; // edge is gone
+
+            // link condition: the endpoints may only share the vertices opposite the edge, otherwise the result is non-manifold
+            collect_neighbours(from, scratch_from);
+            collect_neighbours(to, scratch_to);
+
+            size_t common = 0;
+            for (size_t i = 0, j = 0; i < scratch_from.size() && j < scratch_to.size();)
+            {
+                if (scratch_from[i] < scratch_to[j])
+                    i++;
+                else if (scratch_from[i] > scratch_to[j])
+                    j++;
+                else
+                {
+                    common++;
+                    i++;
+                    j++;
+                }
+            }
+
+            return common == shared_triangles;
+        }
+
+        size_t perform(uint32_t from, uint32_t to)
+        {
+            size_t removed = 0;
+
+            for (uint32_t t : vertex_triangles[from])
+            {
+                if (!triangle_alive[t])
+                    continue;
+
+                uint32_t *tri = &data.indices[t * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                {
+                    triangle_alive[t] = false;
+                    removed++;
+                    continue;
+                }
+
+                for (size_t k = 0; k < 3; k++)
+                    if (tri[k] == from)
+                        tri[k] = to;
+                vertex_triangles[to].push_back(t);
+            }
+
+            version[from]++;
+            vertex_triangles[from] = std::vector<uint32_t>();
+
+            std::vector<uint32_t> &around = vertex_triangles[to];
+            around.erase(std::remove_if(around.begin(), around.end(), [this](uint32_t t) { return !triangle_alive[t]; }), around.end());
+
+            quadrics[to].add(quadrics[from]);
+
+            // every edge touching to has a new cost, which can change the cheapest collapse of to and of its neighbours
+            requeue(to);
+            collect_neighbours(to, scratch_to);
+            for (uint32_t neighbour : scratch_to)
+                requeue(neighbour);
+
+            return removed;
+        }
+    };
+
+    // uniform grid over a mesh's triangles, for closest point queries
+    class triangle_grid
+    {
+    public:
+        triangle_grid(const mesh_data &data) : data(data)
+        {
+            size_t triangle_count = data.indices.size() / 3;
+
+            for (size_t c = 0; c < 3; c++)
+            {
+                low[c] = std::numeric_limits<float>::max();
+                high[c] = std::numeric_limits<float>::lowest();
+            }
+            for (size_t v = 0; v < data.vertex_count(); v++)
+            {
+                for (size_t c = 0; c < 3; c++)
+                {
+                    low[c] = std::min(low[c], data.vertices[v * 3 + c]);
+                    high[c] = std::max(high[c], data.vertices[v * 3 + c]);
+                }
+            }
+
+            // roughly one triangle per cell
+            float extent = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2], 1e-6f});
+            cell_size = extent / std::max(1.0f, std::cbrt((float)triangle_count));
+            for (size_t c = 0; c < 3; c++)
+                resolution[c] = std::max(1, std::min(512, (int)std::ceil((high[c] - low[c]) / cell_size)));
+
+            // counted one cell ahead, so after the prefix sum counts[i] is where cell i starts
+            std::vector<uint32_t> counts(cell_count() + 1, 0);
+            for_each_cell_pass(counts, nullptr);
+            for (size_t i = 1; i < counts.size(); i++)
+                counts[i] += counts[i - 1];
+            cell_start = counts;
+            cell_triangles.resize(counts.back());
+            std::vector<uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+            for_each_cell_pass(fill, &cell_triangles);
+        }
+
+        float distance(const float *p) const
+        {
+            int cell[3];
+            for (size_t c = 0; c < 3; c++)
+                cell[c] = clamp_cell((int)std::floor((p[c] - low[c]) / cell_size), c);
+
+            double best = std::numeric_limits<double>::max();
+            int max_ring = std::max({resolution[0], resolution[1], resolution[2]});
+
+            for (int ring = 0; ring <= max_ring; ring++)
+            {
+                for (int x = cell[0] - ring; x <= cell[0] + ring; x++)
+                    for (int y = cell[1] - ring; y <= cell[1] + ring; y++)
+                        for (int z = cell[2] - ring; z <= cell[2] + ring; z++)
+                        {
+                            if (std::max({std::abs(x - cell[0]), std::abs(y - cell[1]), std::abs(z - cell[2])}) != ring)
+                                continue; // inner shells were already visited
+                            if (x < 0 || y < 0 || z < 0 || x >= resolution[0] || y >= resolution[1] || z >= resolution[2])
+                                continue;
+
+                            size_t index = cell_index(x, y, z);
+                            for (uint32_t i = cell_start[index]; i < cell_start[index + 1]; i++)
+                                best = std::min(best, squared_distance_to_triangle(p, cell_triangles[i]));
+                        }
+
+                // anything in the next ring is at least ring cells away
+                double reach = ring * (double)cell_size;
+                if (best <= reach * reach)
+                    break;
+            }
+
+            return (float)std::sqrt(best);
+        }
+
+    private:
+        const mesh_data &data;
+        float low[3], high[3];
+        float cell_size;
+        int resolution[3];
+        std::vector<uint32_t> cell_start;
+        std::vector<uint32_t> cell_triangles;
+
+        size_t cell_count() const { return (size_t)resolution[0] * resolution[1] * resolution[2]; }
+        size_t cell_index(int x, int y, int z) const { return ((size_t)z * resolution[1] + y) * resolution[0] + x; }
+        int clamp_cell(int value, size_t axis) const { return std::max(0, std::min(resolution[axis] - 1, value)); }
+
+        // counts (offset by one) or fills triangles into every cell their bounding box overlaps
+        void for_each_cell_pass(std::vector<uint32_t> &cursor, std::vector<uint32_t> *out) const
+        {
+            for (uint32_t t = 0; t < data.indices.size() / 3; t++)
+            {
+                int from[3], to[3];
+                for (size_t c = 0; c < 3; c++)
+                {
+                    float a = data.vertices[data.indices[t * 3] * 3 + c];
+                    float b = data.vertices[data.indices[t * 3 + 1] * 3 + c];
+                    float d = data.vertices[data.indices[t * 3 + 2] * 3 + c];
+                    from[c] = clamp_cell((int)std::floor((std::min({a, b, d}) - low[c]) / cell_size), c);
+                    to[c] = clamp_cell((int)std::floor((std::max({a, b, d}) - low[c]) / cell_size), c);
+                }
+
+                for (int z = from[2]; z <= to[2]; z++)
+                    for (int y = from[1]; y <= to[1]; y++)
+                        for (int x = from[0]; x <= to[0]; x++)
+                        {
+                            if (out)
+                                (*out)[cursor[cell_index(x, y, z)]++] = t;
+                            else
+                                cursor[cell_index(x, y, z) + 1]++;
+                        }
+            }
+        }
+
+        // closest point on triangle (Ericson, Real-Time Collision Detection 5.1.5)
+        double squared_distance_to_triangle(const float *point, uint32_t t) const
+        {
+            double a[3], b[3], c[3], p[3];
+            for (size_t k = 0; k < 3; k++)
+            {
+                a[k] = data.vertices[data.indices[t * 3] * 3 + k];
+                b[k] = data.vertices[data.indices[t * 3 + 1] * 3 + k];
+                c[k] = data.vertices[data.indices[t * 3 + 2] * 3 + k];
+                p[k] = point[k];
+            }
+
+            auto dot = [](const double *u, const double *v) { return u[0] * v[0] + u[1] * v[1] + u[2] * v[2]; };
+            auto squared = [](const double *u, const double *v) {
+                double d0 = u[0] - v[0], d1 = u[1] - v[1], d2 = u[2] - v[2];
+                return d0 * d0 + d1 * d1 + d2 * d2;
+            };
+
+            double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+            double ap[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+
+            double d1 = dot(ab, ap), d2 = dot(ac, ap);
+            if (d1 <= 0 && d2 <= 0)
+                return squared(p, a);
+
+            double bp[3] = {p[0] - b[0], p[1] - b[1], p[2] - b[2]};
+            double d3 = dot(ab, bp), d4 = dot(ac, bp);
+            if (d3 >= 0 && d4 <= d3)
+                return squared(p, b);
+
+            double vc = d1 * d4 - d3 * d2;
+            if (vc <= 0 && d1 >= 0 && d3 <= 0)
+            {
+                double v = d1 / (d1 - d3);
+                double q[3] = {a[0] + v * ab[0], a[1] + v * ab[1], a[2] + v * ab[2]};
+                return squared(p, q);
+            }
+
+            double cp[3] = {p[0] - c[0], p[1] - c[1], p[2] - c[2]};
+            double d5 = dot(ab, cp), d6 = dot(ac, cp);
+            if (d6 >= 0 && d5 <= d6)
+                return squared(p, c);
+
+            double vb = d5 * d2 - d1 * d6;
+            if (vb <= 0 && d2 >= 0 && d6 <= 0)
+            {
+                double w = d2 / (d2 - d6);
+                double q[3] = {a[0] + w * ac[0], a[1] + w * ac[1], a[2] + w * ac[2]};
+                return squared(p, q);
+            }
+
+            double va = d3 * d6 - d5 * d4;
+            if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+            {
+                double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+                double q[3] = {b[0] + w * (c[0] - b[0]), b[1] + w * (c[1] - b[1]), b[2] + w * (c[2] - b[2])};
+                return squared(p, q);
+            }
+
+            double denominator = va + vb + vc;
+            if (denominator == 0)
+                return squared(p, a); // degenerate triangle
+
+            double v = vb / denominator, w = vc / denominator;
+            double q[3] = {a[0] + ab[0] * v + ac[0] * w, a[1] + ab[1] * v + ac[1] * w, a[2] + ab[2] * v + ac[2] * w};
+            return squared(p, q);
+        }
+    };
+
+    float one_sided_distance(const mesh_data &from, const mesh_data &to)
+    {
+        triangle_grid grid(to);
+
+        // only vertices that are actually used by a triangle count
+        std::vector<bool> used(from.vertex_count(), false);
+        for (uint32_t index : from.indices)
+            used[index] = true;
+
+        float worst = 0;
+        for (size_t v = 0; v < from.vertex_count(); v++)
+            if (used[v])
+                worst = std::max(worst, grid.distance(&from.vertices[v * 3]));
+        return worst;
+    }
+}
+
+size_t mesh_simplifier::simplify(mesh_data &data, float target_ratio)
+{
+    size_t triangle_count = data.indices.size() / 3;
+    size_t target = (size_t)std::ceil(triangle_count * std::max(0.0f, std::min(1.0f, target_ratio)));
+
+    if (target >= triangle_count)
+        return triangle_count;
+
+    simplifier worker(data);
+    size_t remaining = worker.run(target);
+
+    mesh_optimizer::optimize_vertex_fetch(data); // drops the collapsed vertices
+    return remaining;
+}
+
+float mesh_simplifier::hausdorff_distance(const mesh_data &a, const mesh_data &b)
+{
+    if (a.indices.empty() || b.indices.empty())
+        return 0.0f;
+
+    return std::max(one_sided_distance(a, b), one_sided_distance(b, a));
+}
@@ -0,0 +1,710 @@
+#include "utils/model_file.hpp"
+#include "utils/mapped_file.hpp"
+#include "utils/quantization.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+    uint64_t align_offset(uint64_t offset)
+    {
+        return (offset + MODEL_FILE_ALIGNMENT - 1) & ~(uint64_t)(MODEL_FILE_ALIGNMENT - 1);
+    }
+
+    bool section_fits(uint64_t offset, uint64_t byte_count, size_t file_size)
+    {
+        if (offset % MODEL_FILE_ALIGNMENT != 0)
+            return false;
+        return offset <= file_size && byte_count <= file_size - offset;
+    }
+
+    template <typename T>
+    void write_line(std::ofstream &file, const std::vector<T> &values)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (i != 0)
+                file << ";";
+            file << values[i];
+        }
+    }
+
+    struct text_line
+    {
+        const char *begin;
+        const char *end;
+    };
+
+    // splits the next line off [cursor, data_end), without the line terminator
+    bool next_line(const char *&cursor, const char *data_end, text_line &line)
+    {
+        if (cursor >= data_end)
+            return false;
+
+        const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', data_end - cursor));
+        line.begin = cursor;
+        line.end = newline ? newline : data_end;
+        cursor = newline ? newline + 1 : data_end;
+
+        if (line.end > line.begin && *(line.end - 1) == '\r')
+            line.end--;
+
+        return true;
+    }
+
+    bool is_blank(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    // parses every ';' separated value in a line, appending to values
+    template <typename T>
+    bool parse_values(const text_line &line, std::vector<T> &values)
+    {
+        values.reserve(values.size() + std::count(line.begin, line.end, ';') + 1);
+
+        const char *cursor = line.begin;
+        while (cursor < line.end)
+        {
+            while (cursor < line.end && is_blank(*cursor))
+                cursor++;
+
+            if (cursor == line.end)
+                break;
+
+            if (*cursor == ';') // tolerate empty tokens, e.g. a trailing ';'
+            {
+                cursor++;
+                continue;
+            }
+
+            T value;
+            std::from_chars_result result = std::from_chars(cursor, line.end, value);
+            if (result.ec != std::errc())
+                return false;
+
+            values.push_back(value);
+            cursor = result.ptr;
+
+            while (cursor < line.end && is_blank(*cursor))
+                cursor++;
+
+            if (cursor < line.end)
+            {
+                if (*cursor != ';')
+                    return false;
+                cursor++;
+            }
+        }
+
+        return true;
+    }
+
+    void write_padding(std::ofstream &file, uint64_t &position)
+    {
+        static const char zeros[MODEL_FILE_ALIGNMENT] = {0};
+        uint64_t aligned = align_offset(position);
+        file.write(zeros, aligned - position);
+        position = aligned;
+    }
+}
+
+bool model_file::is_binary(const unsigned char *data, size_t size)
+{
+    return size >= 4 && std::memcmp(data, MODEL_FILE_MAGIC, 4) == 0;
+}
+
+const model_file_header *model_file::read_binary_header(const unsigned char *data, size_t size, std::string &error)
+{
+    std::stringstream ss;
+
+    if (size < sizeof(model_file_header) || !is_binary(data, size))
+    {
+        error = "File is too small or isn't a binary .3d file!";
+        return nullptr;
+    }
+
+    const model_file_header *header = reinterpret_cast<const model_file_header *>(data);
+    if (header->version != MODEL_FILE_VERSION)
+    {
+        ss << "Unsupported binary .3d version " << header->version << " (expected " << MODEL_FILE_VERSION << "). Regenerate the file.";
+        error = ss.str();
+        return nullptr;
+    }
+
+    uint64_t vertex_count = header->vertex_count;
+    uint64_t index_count = header->index_count;
+
+    bool interleaved = header->flags & MODEL_FLAG_INTERLEAVED;
+    uint32_t all_attributes = MODEL_FLAG_NORMALS | MODEL_FLAG_TEXTURE_COORDINATES;
+
+    bool quantized = header->flags & MODEL_FLAG_QUANTIZED;
+    size_t vertex_size = quantized ? quantized_stride(header->flags) : (interleaved ? MODEL_INTERLEAVED_STRIDE : 3) * sizeof(float);
+
+    bool valid = section_fits(header->vertices_offset, vertex_count * vertex_size, size);
+    size_t index_size = (header->flags & MODEL_FLAG_SHORT_INDICES) ? sizeof(uint16_t) : sizeof(uint32_t);
+    // bounded first, a huge count would wrap the section size around to something that fits
+    if (header->flags & MODEL_FLAG_INDICES)
+        valid = valid && index_count <= size / index_size && section_fits(header->indices_offset, index_count * index_size, size);
+    if ((header->flags & MODEL_FLAG_SHORT_INDICES) && vertex_count > MODEL_SHORT_INDEX_LIMIT)
+        valid = false;
+    if (interleaved)
+        valid = valid && !quantized && (header->flags & all_attributes) == all_attributes;
+    else if (!quantized)
+    {
+        if (header->flags & MODEL_FLAG_NORMALS)
+            valid = valid && section_fits(header->normals_offset, vertex_count * 3 * sizeof(float), size);
+        if (header->flags & MODEL_FLAG_TEXTURE_COORDINATES)
+            valid = valid && section_fits(header->tex_coords_offset, vertex_count * 2 * sizeof(float), size);
+    }
+
+    if (!valid || vertex_count == 0 || vertex_count > size)
+    {
+        error = "Binary .3d file is truncated or has invalid section offsets!";
+        return nullptr;
+    }
+
+    return header;
+}
+
+bool model_file::check_binary_indices(const model_file_header *header, const unsigned char *data, std::string &error)
+{
+    if (!(header->flags & MODEL_FLAG_INDICES))
+        return true;
+
+    bool in_range = true;
+    if (header->flags & MODEL_FLAG_SHORT_INDICES)
+    {
+        const uint16_t *indices = reinterpret_cast<const uint16_t *>(data + header->indices_offset);
+        for (uint64_t i = 0; i < header->index_count && in_range; i++)
+            in_range = indices[i] < header->vertex_count;
+    }
+    else
+    {
+        const uint32_t *indices = reinterpret_cast<const uint32_t *>(data + header->indices_offset);
+        for (uint64_t i = 0; i < header->index_count && in_range; i++)
+            in_range = indices[i] < header->vertex_count;
+    }
+
+    if (!in_range)
+        error = "Binary .3d file has out of range indices!";
+    return in_range;
+}
+
+bool model_file::parse_text(const char *data, size_t size, mesh_data &out, std::string &error)
+{
+    std::stringstream ss;
+    const char *cursor = data;
+    const char *data_end = data + size;
+    text_line line;
+
+    out = mesh_data();
+
+    // settings
+    if (!next_line(cursor, data_end, line) || line.end - line.begin < 3)
+    {
+        error = "Missing or incomplete settings line!";
+        return false;
+    }
+
+    bool has_indices = line.begin[0] == '1';
+    bool has_normals = line.begin[1] == '1';
+    bool has_tex_coords = line.begin[2] == '1';
+
+    // bounds: sphere center and radius, then the box's min and max corners (older files only have the sphere)
+    std::vector<float> bounds_info;
+    if (!next_line(cursor, data_end, line) || !parse_values(line, bounds_info) || (bounds_info.size() != 4 && bounds_info.size() != 10))
+    {
+        error = "Missing or invalid bounds line!";
+        return false;
+    }
+
+    // vertices
+    if (!next_line(cursor, data_end, line) || !parse_values(line, out.vertices) || out.vertices.size() % 3 != 0)
+    {
+        error = "Missing or invalid vertex line!";
+        return false;
+    }
+
+    if (has_indices && (!next_line(cursor, data_end, line) || !parse_values(line, out.indices)))
+    {
+        error = "Missing or invalid index line!";
+        return false;
+    }
+
+    if (has_normals && (!next_line(cursor, data_end, line) || !parse_values(line, out.normals) || out.normals.size() != out.vertices.size()))
+    {
+        error = "Missing or invalid normal line! There must be one normal per vertex.";
+        return false;
+    }
+
+    if (has_tex_coords && (!next_line(cursor, data_end, line) || !parse_values(line, out.tex_coords) || out.tex_coords.size() / 2 != out.vertices.size() / 3))
+    {
+        error = "Missing or invalid texture coordinate line! There must be one texture coordinate per vertex.";
+        return false;
+    }
+
+    size_t vertex_count = out.vertex_count();
+    for (uint32_t index : out.indices)
+    {
+        if (index >= vertex_count)
+        {
+            ss << "Index " << index << " is out of range (" << vertex_count << " vertices)!";
+            error = ss.str();
+            return false;
+        }
+    }
+
+    if (bounds_info.size() == 10)
+    {
+        out.bounding_sphere = vector4(bounds_info[0], bounds_info[1], bounds_info[2], bounds_info[3]);
+        out.aabb_min = vector3(bounds_info[4], bounds_info[5], bounds_info[6]);
+        out.aabb_max = vector3(bounds_info[7], bounds_info[8], bounds_info[9]);
+    }
+    else
+        compute_bounds(out); // the old sphere was often just a guess, recompute everything
+
+    return true;
+}
+
+bool model_file::read(const std::string &filepath, mesh_data &out, std::string &error)
+{
+    mapped_file file;
+    if (!file.open(filepath))
+    {
+        error = "Failed to open file!";
+        return false;
+    }
+
+    if (!is_binary(file.data(), file.size()))
+        return parse_text(reinterpret_cast<const char *>(file.data()), file.size(), out, error);
+
+    return read_binary(file.data(), file.size(), out, error);
+}
+
+bool model_file::read_binary(const unsigned char *data, size_t size, mesh_data &out, std::string &error)
+{
+    const model_file_header *header = read_binary_header(data, size, error);
+    if (!header)
+        return false;
+
+    size_t vertex_count = header->vertex_count;
+
+    out = mesh_data();
+    out.bounding_sphere = vector4(header->bounding_sphere[0], header->bounding_sphere[1], header->bounding_sphere[2], header->bounding_sphere[3]);
+    out.aabb_min = vector3(header->aabb_min[0], header->aabb_min[1], header->aabb_min[2]);
+    out.aabb_max = vector3(header->aabb_max[0], header->aabb_max[1], header->aabb_max[2]);
+
+    if (header->flags & MODEL_FLAG_QUANTIZED)
+    {
+        size_t stride = quantized_stride(header->flags);
+        const unsigned char *source = data + header->vertices_offset;
+        const float *box = header->quantization;
+
+        out.vertices.resize(vertex_count * 3);
+        if (header->flags & MODEL_FLAG_NORMALS)
+            out.normals.resize(vertex_count * 3);
+        if (header->flags & MODEL_FLAG_TEXTURE_COORDINATES)
+            out.tex_coords.resize(vertex_count * 2);
+
+        for (size_t i = 0; i < vertex_count; i++, source += stride)
+        {
+            const unsigned char *field = source;
+
+            int16_t position[3];
+            std::memcpy(position, field, sizeof(position));
+            for (size_t c = 0; c < 3; c++)
+                out.vertices[i * 3 + c] = box[c] + quantization::decode_snorm16(position[c]) * box[3];
+            field += 4 * sizeof(int16_t);
+
+            if (header->flags & MODEL_FLAG_NORMALS)
+            {
+                uint32_t normal;
+                std::memcpy(&normal, field, sizeof(normal));
+                quantization::decode_normal_2_10_10_10(normal, out.normals[i * 3], out.normals[i * 3 + 1], out.normals[i * 3 + 2]);
+                field += sizeof(uint32_t);
+            }
+
+            if (header->flags & MODEL_FLAG_TEXTURE_COORDINATES)
+            {
+                uint16_t uv[2];
+                std::memcpy(uv, field, sizeof(uv));
+                out.tex_coords[i * 2] = quantization::decode_half(uv[0]);
+                out.tex_coords[i * 2 + 1] = quantization::decode_half(uv[1]);
+            }
+        }
+    }
+    else if (header->flags & MODEL_FLAG_INTERLEAVED)
+    {
+        const float *source = reinterpret_cast<const float *>(data + header->vertices_offset);
+        out.vertices.resize(vertex_count * 3);
+        out.normals.resize(vertex_count * 3);
+        out.tex_coords.resize(vertex_count * 2);
+
+        for (size_t i = 0; i < vertex_count; i++, source += MODEL_INTERLEAVED_STRIDE)
+        {
+            std::memcpy(&out.vertices[i * 3], source, 3 * sizeof(float));
+            std::memcpy(&out.normals[i * 3], source + 3, 3 * sizeof(float));
+            std::memcpy(&out.tex_coords[i * 2], source + 6, 2 * sizeof(float));
+        }
+    }
+    else
+    {
+        const float *vertices = reinterpret_cast<const float *>(data + header->vertices_offset);
+        out.vertices.assign(vertices, vertices + vertex_count * 3);
+
+        if (header->flags & MODEL_FLAG_NORMALS)
+        {
+            const float *normals = reinterpret_cast<const float *>(data + header->normals_offset);
+            out.normals.assign(normals, normals + vertex_count * 3);
+        }
+
+        if (header->flags & MODEL_FLAG_TEXTURE_COORDINATES)
+        {
+            const float *tex_coords = reinterpret_cast<const float *>(data + header->tex_coords_offset);
+            out.tex_coords.assign(tex_coords, tex_coords + vertex_count * 2);
+        }
+    }
+
+    if (header->flags & MODEL_FLAG_INDICES)
+    {
+        if (header->flags & MODEL_FLAG_SHORT_INDICES)
+        {
+            const uint16_t *indices = reinterpret_cast<const uint16_t *>(data + header->indices_offset);
+            out.indices.assign(indices, indices + header->index_count);
+        }
+        else
+        {
+            const uint32_t *indices = reinterpret_cast<const uint32_t *>(data + header->indices_offset);
+            out.indices.assign(indices, indices + header->index_count);
+        }
+    }
+
+    return check_binary_indices(header, data, error);
+}
+
+void model_file::compute_bounds(mesh_data &data)
+{
+    size_t vertex_count = data.vertex_count();
+    if (vertex_count == 0)
+    {
+        data.bounding_sphere = vector4();
+        data.aabb_min = data.aabb_max = vector3();
+        return;
+    }
+
+    const float *v = data.vertices.data();
+
+    // box, remembering the extreme vertex along each axis for the sphere's starting guess
+    size_t min_vertex[3] = {0, 0, 0}, max_vertex[3] = {0, 0, 0};
+    for (size_t i = 1; i < vertex_count; i++)
+    {
+        for (size_t c = 0; c < 3; c++)
+        {
+            if (v[i * 3 + c] < v[min_vertex[c] * 3 + c])
+                min_vertex[c] = i;
+            if (v[i * 3 + c] > v[max_vertex[c] * 3 + c])
+                max_vertex[c] = i;
+        }
+    }
+    data.aabb_min = vector3(v[min_vertex[0] * 3], v[min_vertex[1] * 3 + 1], v[min_vertex[2] * 3 + 2]);
+    data.aabb_max = vector3(v[max_vertex[0] * 3], v[max_vertex[1] * 3 + 1], v[max_vertex[2] * 3 + 2]);
+
+    auto squared_distance = [v](size_t i, const double *center) {
+        double dx = v[i * 3] - center[0], dy = v[i * 3 + 1] - center[1], dz = v[i * 3 + 2] - center[2];
+        return dx * dx + dy * dy + dz * dz;
+    };
+
+    // Ritter: start from the most separated pair of axis extremes, then grow the sphere to take in every point outside it
+    size_t axis = 0;
+    double widest = -1;
+    for (size_t c = 0; c < 3; c++)
+    {
+        double center[3] = {v[min_vertex[c] * 3], v[min_vertex[c] * 3 + 1], v[min_vertex[c] * 3 + 2]};
+        double span = squared_distance(max_vertex[c], center);
+        if (span > widest)
+        {
+            widest = span;
+            axis = c;
+        }
+    }
+
+    double center[3], radius = std::sqrt(widest) * 0.5;
+    for (size_t c = 0; c < 3; c++)
+        center[c] = ((double)v[min_vertex[axis] * 3 + c] + v[max_vertex[axis] * 3 + c]) * 0.5;
+
+    for (size_t i = 0; i < vertex_count; i++)
+    {
+        double d2 = squared_distance(i, center);
+        if (d2 > radius * radius)
+        {
+            double d = std::sqrt(d2);
+            double new_radius = (radius + d) * 0.5;
+            double shift = (new_radius - radius) / d;
+            for (size_t c = 0; c < 3; c++)
+                center[c] += (v[i * 3 + c] - center[c]) * shift;
+            radius = new_radius;
+        }
+    }
+
+    // symmetric shapes are often bounded tighter by the sphere around the box center
+    double box_center[3] = {((double)data.aabb_min.x + data.aabb_max.x) * 0.5, ((double)data.aabb_min.y + data.aabb_max.y) * 0.5, ((double)data.aabb_min.z + data.aabb_max.z) * 0.5};
+    double box_radius2 = 0;
+    for (size_t i = 0; i < vertex_count; i++)
+        box_radius2 = std::max(box_radius2, squared_distance(i, box_center));
+
+    if (std::sqrt(box_radius2) < radius)
+    {
+        std::memcpy(center, box_center, sizeof(center));
+        radius = std::sqrt(box_radius2);
+    }
+
+    // re-measure from the center as stored, and round up, so float rounding can't leave a vertex poking out
+    double stored_center[3] = {(float)center[0], (float)center[1], (float)center[2]};
+    double stored_radius2 = 0;
+    for (size_t i = 0; i < vertex_count; i++)
+        stored_radius2 = std::max(stored_radius2, squared_distance(i, stored_center));
+
+    float stored_radius = std::nextafter((float)std::sqrt(stored_radius2), std::numeric_limits<float>::max());
+    data.bounding_sphere = vector4((float)stored_center[0], (float)stored_center[1], (float)stored_center[2], stored_radius);
+}
+
+void model_file::interleave(const float *vertices, const float *normals, const float *tex_coords, size_t vertex_count, std::vector<float> &out)
+{
+    out.resize(vertex_count * MODEL_INTERLEAVED_STRIDE);
+
+    float *dst = out.data();
+    for (size_t i = 0; i < vertex_count; i++)
+    {
+        std::memcpy(dst, vertices + i * 3, 3 * sizeof(float));
+        std::memcpy(dst + 3, normals + i * 3, 3 * sizeof(float));
+        std::memcpy(dst + 6, tex_coords + i * 2, 2 * sizeof(float));
+        dst += MODEL_INTERLEAVED_STRIDE;
+    }
+}
+
+void model_file::narrow_indices(const std::vector<uint32_t> &indices, std::vector<uint16_t> &out)
+{
+    out.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); i++)
+        out[i] = static_cast<uint16_t>(indices[i]);
+}
+
+bool model_file::write_text(const std::string &filepath, const mesh_data &data)
+{
+    std::ofstream file(filepath);
+    if (!file.is_open())
+        return false;
+
+    // settings
+    file << (data.has_indices() ? '1' : '0') << (data.has_normals() ? '1' : '0') << (data.has_tex_coords() ? '1' : '0') << "\n";
+
+    // bounds at full precision, 6 digits could round the radius below the farthest vertex
+    const vector4 &bs = data.bounding_sphere;
+    std::streamsize precision = file.precision(std::numeric_limits<float>::max_digits10);
+    file << bs.x << ";" << bs.y << ";" << bs.z << ";" << bs.w << ";";
+    file << data.aabb_min.x << ";" << data.aabb_min.y << ";" << data.aabb_min.z << ";";
+    file << data.aabb_max.x << ";" << data.aabb_max.y << ";" << data.aabb_max.z << "\n";
+    file.precision(precision);
+
+    write_line(file, data.vertices);
+
+    if (data.has_indices())
+    {
+        file << "\n";
+        write_line(file, data.indices);
+    }
+
+    if (data.has_normals())
+    {
+        file << "\n";
+        write_line(file, data.normals);
+    }
+
+    if (data.has_tex_coords())
+    {
+        file << "\n";
+        write_line(file, data.tex_coords);
+    }
+
+    file << std::flush;
+    file.close();
+
+    return true;
+}
+
+bool model_file::write_binary(const std::string &filepath, const mesh_data &data, bool quantize)
+{
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    model_file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MODEL_FILE_MAGIC, 4);
+    header.version = MODEL_FILE_VERSION;
+
+    header.bounding_sphere[0] = data.bounding_sphere.x;
+    header.bounding_sphere[1] = data.bounding_sphere.y;
+    header.bounding_sphere[2] = data.bounding_sphere.z;
+    header.bounding_sphere[3] = data.bounding_sphere.w;
+
+    header.aabb_min[0] = data.aabb_min.x;
+    header.aabb_min[1] = data.aabb_min.y;
+    header.aabb_min[2] = data.aabb_min.z;
+    header.aabb_max[0] = data.aabb_max.x;
+    header.aabb_max[1] = data.aabb_max.y;
+    header.aabb_max[2] = data.aabb_max.z;
+
+    header.vertex_count = data.vertex_count();
+    header.index_count = data.indices.size();
+
+    // quantized and interleaved meshes replace the vertex, normal and uv arrays with a single one
+    bool interleaved = !quantize && data.can_interleave();
+    bool packed = quantize || interleaved; // < -- normals and uvs live in the vertex array
+    std::vector<float> interleaved_vertices;
+    std::vector<unsigned char> quantized_vertices;
+    const char *vertex_bytes = reinterpret_cast<const char *>(data.vertices.data());
+    size_t vertex_section_size = data.vertices.size() * sizeof(float);
+
+    if (quantize)
+    {
+        header.flags |= MODEL_FLAG_QUANTIZED;
+        if (data.has_normals())
+            header.flags |= MODEL_FLAG_NORMALS;
+        if (data.has_tex_coords())
+            header.flags |= MODEL_FLAG_TEXTURE_COORDINATES;
+
+        // positions are snorm16 inside a cube around the box center, sized to the box's largest half extent
+        // (measured from the vertices, in case the stored box is stale)
+        for (size_t c = 0; c < 3; c++)
+            header.quantization[c] = (header.aabb_min[c] + header.aabb_max[c]) * 0.5f;
+
+        float extent = 1e-6f;
+        for (size_t i = 0; i < data.vertex_count(); i++)
+            for (size_t c = 0; c < 3; c++)
+                extent = std::max(extent, std::fabs(data.vertices[i * 3 + c] - header.quantization[c]));
+        header.quantization[3] = extent;
+
+        size_t stride = quantized_stride(header.flags);
+        quantized_vertices.resize(data.vertex_count() * stride);
+
+        unsigned char *destination = quantized_vertices.data();
+        for (size_t i = 0; i < data.vertex_count(); i++, destination += stride)
+        {
+            unsigned char *field = destination;
+
+            int16_t position[4] = {0, 0, 0, 0};
+            for (size_t c = 0; c < 3; c++)
+                position[c] = quantization::encode_snorm16((data.vertices[i * 3 + c] - header.quantization[c]) / extent);
+            std::memcpy(field, position, sizeof(position));
+            field += sizeof(position);
+
+            if (data.has_normals())
+            {
+                uint32_t normal = quantization::encode_normal_2_10_10_10(data.normals[i * 3], data.normals[i * 3 + 1], data.normals[i * 3 + 2]);
+                std::memcpy(field, &normal, sizeof(normal));
+                field += sizeof(normal);
+            }
+
+            if (data.has_tex_coords())
+            {
+                uint16_t uv[2] = {quantization::encode_half(data.tex_coords[i * 2]), quantization::encode_half(data.tex_coords[i * 2 + 1])};
+                std::memcpy(field, uv, sizeof(uv));
+            }
+        }
+
+        vertex_bytes = reinterpret_cast<const char *>(quantized_vertices.data());
+        vertex_section_size = quantized_vertices.size();
+    }
+    else if (interleaved)
+    {
+        interleave(data.vertices.data(), data.normals.data(), data.tex_coords.data(), data.vertex_count(), interleaved_vertices);
+        header.flags |= MODEL_FLAG_INTERLEAVED | MODEL_FLAG_NORMALS | MODEL_FLAG_TEXTURE_COORDINATES;
+
+        vertex_bytes = reinterpret_cast<const char *>(interleaved_vertices.data());
+        vertex_section_size = interleaved_vertices.size() * sizeof(float);
+    }
+
+    bool short_indices = data.has_indices() && data.can_use_short_indices();
+    std::vector<uint16_t> narrowed_indices;
+    if (short_indices)
+    {
+        narrow_indices(data.indices, narrowed_indices);
+        header.flags |= MODEL_FLAG_SHORT_INDICES;
+    }
+    const char *index_bytes = short_indices ? reinterpret_cast<const char *>(narrowed_indices.data()) : reinterpret_cast<const char *>(data.indices.data());
+    size_t index_section_size = data.indices.size() * (short_indices ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    // lay out sections
+    uint64_t offset = align_offset(sizeof(model_file_header));
+
+    header.vertices_offset = offset;
+    offset = align_offset(offset + vertex_section_size);
+
+    if (data.has_indices())
+    {
+        header.flags |= MODEL_FLAG_INDICES;
+        header.indices_offset = offset;
+        offset = align_offset(offset + index_section_size);
+    }
+
+    if (data.has_normals() && !packed)
+    {
+        header.flags |= MODEL_FLAG_NORMALS;
+        header.normals_offset = offset;
+        offset = align_offset(offset + data.normals.size() * sizeof(float));
+    }
+
+    if (data.has_tex_coords() && !packed)
+    {
+        header.flags |= MODEL_FLAG_TEXTURE_COORDINATES;
+        header.tex_coords_offset = offset;
+    }
+
+    // write them in the same order
+    uint64_t position = sizeof(model_file_header);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    write_padding(file, position);
+    file.write(vertex_bytes, vertex_section_size);
+    position += vertex_section_size;
+
+    if (data.has_indices())
+    {
+        write_padding(file, position);
+        file.write(index_bytes, index_section_size);
+        position += index_section_size;
+    }
+
+    if (data.has_normals() && !packed)
+    {
+        write_padding(file, position);
+        file.write(reinterpret_cast<const char *>(data.normals.data()), data.normals.size() * sizeof(float));
+        position += data.normals.size() * sizeof(float);
+    }
+
+    if (data.has_tex_coords() && !packed)
+    {
+        write_padding(file, position);
+        file.write(reinterpret_cast<const char *>(data.tex_coords.data()), data.tex_coords.size() * sizeof(float));
+        position += data.tex_coords.size() * sizeof(float);
+    }
+
+    file.close();
+    return true;
+}
+
+bool model_file::write(const std::string &filepath, const mesh_data &data, format output_format)
+{
+    if (output_format == FORMAT_BINARY || output_format == FORMAT_QUANTIZED)
+        return write_binary(filepath, data, output_format == FORMAT_QUANTIZED);
+
+    return write_text(filepath, data);
+}
@@ -0,0 +1,172 @@
+#include "utils/scene_pack.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    uint64_t align_offset(uint64_t offset)
+    {
+        return (offset + SCENE_PACK_ALIGNMENT - 1) & ~(uint64_t)(SCENE_PACK_ALIGNMENT - 1);
+    }
+
+    void write_padding(std::ofstream &file, uint64_t &position)
+    {
+        static const char zeros[SCENE_PACK_ALIGNMENT] = {0};
+        uint64_t aligned = align_offset(position);
+        file.write(zeros, aligned - position);
+        position = aligned;
+    }
+}
+
+bool scene_pack::is_pack(const std::string &filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    char magic[4];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, SCENE_PACK_MAGIC, sizeof(magic)) == 0;
+}
+
+bool scene_pack::open(const std::string &filepath, std::string &error)
+{
+    std::stringstream ss;
+
+    entries.clear();
+    index.clear();
+
+    if (!file.open(filepath))
+    {
+        error = "Failed to open file!";
+        return false;
+    }
+
+    const unsigned char *data = file.data();
+    size_t size = file.size();
+
+    if (size < sizeof(scene_pack_header) || std::memcmp(data, SCENE_PACK_MAGIC, 4) != 0)
+    {
+        error = "File is too small or isn't a .pack file!";
+        return false;
+    }
+
+    scene_pack_header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != SCENE_PACK_VERSION)
+    {
+        ss << "Unsupported .pack version " << header.version << " (expected " << SCENE_PACK_VERSION << "). Rebuild the pack.";
+        error = ss.str();
+        return false;
+    }
+
+    uint64_t table_size = (uint64_t)header.entry_count * sizeof(scene_pack_entry);
+    if (header.entry_count == 0 || table_size > size - sizeof(header) || header.names_offset > size || header.names_size > size - header.names_offset)
+    {
+        error = "Pack table of contents is truncated or empty!";
+        return false;
+    }
+
+    entries.resize(header.entry_count);
+    std::memcpy(entries.data(), data + sizeof(header), table_size);
+
+    const char *names = reinterpret_cast<const char *>(data + header.names_offset);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const scene_pack_entry &entry = entries[i];
+        bool valid = entry.offset % SCENE_PACK_ALIGNMENT == 0 && entry.offset <= size && entry.size <= size - entry.offset;
+        valid = valid && (uint64_t)entry.name_offset + entry.name_length <= header.names_size;
+        if (!valid)
+        {
+            ss << "Pack entry " << i << " lies outside the file!";
+            error = ss.str();
+            return false;
+        }
+
+        index.emplace(std::string(names + entry.name_offset, entry.name_length), i);
+    }
+
+    return true;
+}
+
+bool scene_pack::find(const std::string &name, const unsigned char *&data, size_t &size) const
+{
+    auto found = index.find(name);
+    if (found == index.end())
+        return false;
+
+    const scene_pack_entry &entry = entries[found->second];
+    data = file.data() + entry.offset;
+    size = entry.size;
+    return true;
+}
+
+bool scene_pack::write(const std::string &filepath, const std::vector<scene_pack_source> &sources, std::string &error)
+{
+    if (sources.empty())
+    {
+        error = "Nothing to pack!";
+        return false;
+    }
+
+    // every source is mapped up front, so sizes are known before anything is written
+    std::vector<mapped_file> contents(sources.size());
+    std::string names;
+    std::vector<scene_pack_entry> entries(sources.size());
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        if (!contents[i].open(sources[i].filepath))
+        {
+            error = "Failed to open " + sources[i].filepath + " (missing or empty)!";
+            return false;
+        }
+
+        entries[i].size = contents[i].size();
+        entries[i].name_offset = (uint32_t)names.size();
+        entries[i].name_length = (uint32_t)sources[i].name.size();
+        names += sources[i].name;
+    }
+
+    scene_pack_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SCENE_PACK_MAGIC, 4);
+    header.version = SCENE_PACK_VERSION;
+    header.entry_count = (uint32_t)entries.size();
+    header.names_offset = sizeof(header) + entries.size() * sizeof(scene_pack_entry);
+    header.names_size = names.size();
+
+    // lay out blobs
+    uint64_t offset = align_offset(header.names_offset + header.names_size);
+    for (scene_pack_entry &entry : entries)
+    {
+        entry.offset = offset;
+        offset = align_offset(offset + entry.size);
+    }
+
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+    {
+        error = "Failed to open output file!";
+        return false;
+    }
+
+    uint64_t position = 0;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(scene_pack_entry));
+    file.write(names.data(), names.size());
+    position = header.names_offset + header.names_size;
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        write_padding(file, position);
+        file.write(reinterpret_cast<const char *>(contents[i].data()), entries[i].size);
+        position += entries[i].size;
+    }
+
+    file.close();
+    if (!file)
+    {
+        error = "Failed to write output file!";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,87 @@
+#include "utils/skyline_packer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+skyline_packer::skyline_packer(uint32_t width, uint32_t height) : width(width), height(height)
+{
+    skyline.push_back({0, 0, width});
+}
+
+bool skyline_packer::fits(size_t index, uint32_t rect_width, uint32_t rect_height, uint32_t &y) const
+{
+    uint32_t x = skyline[index].x;
+    if (x + rect_width > width)
+        return false;
+
+    // the rectangle rests on the highest segment it spans
+    y = 0;
+    uint32_t remaining = rect_width;
+    for (size_t i = index; remaining > 0; i++)
+    {
+        y = std::max(y, skyline[i].y);
+        if (y + rect_height > height)
+            return false;
+        remaining -= std::min(remaining, skyline[i].width);
+    }
+
+    return true;
+}
+
+bool skyline_packer::insert(uint32_t rect_width, uint32_t rect_height, uint32_t &x, uint32_t &y)
+{
+    size_t best_index = skyline.size();
+    uint32_t best_top = std::numeric_limits<uint32_t>::max();
+    uint32_t best_width = std::numeric_limits<uint32_t>::max();
+
+    for (size_t i = 0; i < skyline.size(); i++)
+    {
+        uint32_t candidate_y;
+        if (!fits(i, rect_width, rect_height, candidate_y))
+            continue;
+
+        uint32_t top = candidate_y + rect_height;
+        if (top < best_top || (top == best_top && skyline[i].width < best_width))
+        {
+            best_index = i;
+            best_top = top;
+            best_width = skyline[i].width;
+            y = candidate_y;
+        }
+    }
+
+    if (best_index == skyline.size())
+        return false;
+
+    x = skyline[best_index].x;
+
+    // the new segment replaces whatever it covers, the last covered segment may only be shortened
+    segment placed = {x, y + rect_height, rect_width};
+    size_t end = best_index;
+    while (end < skyline.size() && skyline[end].x + skyline[end].width <= x + rect_width)
+        end++;
+    if (end < skyline.size() && skyline[end].x < x + rect_width)
+    {
+        uint32_t cut = x + rect_width - skyline[end].x;
+        skyline[end].x += cut;
+        skyline[end].width -= cut;
+    }
+
+    skyline.erase(skyline.begin() + best_index, skyline.begin() + end);
+    skyline.insert(skyline.begin() + best_index, placed);
+
+    // merge neighbours at the same height, so the list stays short
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+            i++;
+    }
+
+    used_area += (uint64_t)rect_width * rect_height;
+    return true;
+}
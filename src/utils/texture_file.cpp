@@ -0,0 +1,198 @@
+#include "utils/texture_file.hpp"
+#include "utils/mapped_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    uint64_t align_offset(uint64_t offset)
+    {
+        return (offset + TEXTURE_FILE_ALIGNMENT - 1) & ~(uint64_t)(TEXTURE_FILE_ALIGNMENT - 1);
+    }
+
+    uint64_t level_size(const texture_file_level &level)
+    {
+        return (uint64_t)level.width * level.height * 4;
+    }
+}
+
+bool texture_file::stat_source(const std::string &filepath, texture_source_info &info)
+{
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(filepath, error);
+    if (error)
+        return false;
+
+    std::filesystem::file_time_type mtime = std::filesystem::last_write_time(filepath, error);
+    if (error)
+        return false;
+
+    info.size = size;
+    info.mtime = (int64_t)mtime.time_since_epoch().count();
+    return true;
+}
+
+bool texture_file::hash_source(const std::string &filepath, uint64_t &hash)
+{
+    mapped_file file;
+    if (!file.open(filepath))
+        return false;
+
+    hash = 14695981039346656037ull;
+    for (size_t i = 0; i < file.size(); i++)
+    {
+        hash ^= file.data()[i];
+        hash *= 1099511628211ull;
+    }
+    return true;
+}
+
+const texture_file_header *texture_file::read_header(const unsigned char *data, size_t size, std::string &error)
+{
+    if (size < sizeof(texture_file_header) || std::memcmp(data, TEXTURE_FILE_MAGIC, 4) != 0)
+    {
+        error = "File is too small or isn't a .3dt file!";
+        return nullptr;
+    }
+
+    const texture_file_header *header = reinterpret_cast<const texture_file_header *>(data);
+    if (header->version != TEXTURE_FILE_VERSION || header->format != TEXTURE_FORMAT_RGBA8)
+    {
+        error = "Unsupported .3dt version or format!";
+        return nullptr;
+    }
+
+    bool valid = header->level_count > 0 && header->level_count <= TEXTURE_FILE_MAX_LEVELS;
+    for (uint32_t i = 0; valid && i < header->level_count; i++)
+    {
+        const texture_file_level &level = header->levels[i];
+        valid = level.width > 0 && level.height > 0 && level.offset <= size && level_size(level) <= size - level.offset;
+    }
+    valid = valid && header->levels[0].width == header->width && header->levels[0].height == header->height;
+
+    if (!valid)
+    {
+        error = ".3dt file is truncated or has invalid levels!";
+        return nullptr;
+    }
+
+    return header;
+}
+
+bool texture_file::is_up_to_date(const texture_file_header &header, const std::string &source_filepath, texture_source_info &source)
+{
+    if (!stat_source(source_filepath, source) || source.size != header.source_size)
+        return false;
+
+    if (source.mtime == header.source_mtime)
+        return true;
+
+    // touched (copied, checked out again...) but possibly unchanged
+    return hash_source(source_filepath, source.hash) && source.hash == header.source_hash;
+}
+
+void texture_file::build_mip_chain(const unsigned char *pixels, uint32_t width, uint32_t height, mip_chain &out)
+{
+    out.levels.clear();
+
+    // lay out every level first, so pixels is allocated once
+    uint64_t total = 0;
+    for (uint32_t w = width, h = height;; w = std::max(1u, w / 2), h = std::max(1u, h / 2))
+    {
+        texture_file_level level = {total, w, h};
+        out.levels.push_back(level);
+        total += level_size(level);
+
+        if ((w == 1 && h == 1) || out.levels.size() == TEXTURE_FILE_MAX_LEVELS)
+            break;
+    }
+
+    out.pixels.resize(total);
+    std::memcpy(out.pixels.data(), pixels, level_size(out.levels[0]));
+
+    for (size_t l = 1; l < out.levels.size(); l++)
+    {
+        const texture_file_level &source_level = out.levels[l - 1];
+        const texture_file_level &level = out.levels[l];
+        const unsigned char *source = out.pixels.data() + source_level.offset;
+        unsigned char *destination = out.pixels.data() + level.offset;
+
+        for (uint32_t y = 0; y < level.height; y++)
+        {
+            // odd sizes: the last row/column is averaged with itself
+            uint32_t y0 = std::min(y * 2, source_level.height - 1), y1 = std::min(y * 2 + 1, source_level.height - 1);
+            for (uint32_t x = 0; x < level.width; x++)
+            {
+                uint32_t x0 = std::min(x * 2, source_level.width - 1), x1 = std::min(x * 2 + 1, source_level.width - 1);
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    uint32_t sum = source[((size_t)y0 * source_level.width + x0) * 4 + c] + source[((size_t)y0 * source_level.width + x1) * 4 + c] +
+                                   source[((size_t)y1 * source_level.width + x0) * 4 + c] + source[((size_t)y1 * source_level.width + x1) * 4 + c];
+                    destination[((size_t)y * level.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+bool texture_file::write(const std::string &filepath, const mip_chain &chain, const texture_source_info &source)
+{
+    if (chain.levels.empty() || chain.levels.size() > TEXTURE_FILE_MAX_LEVELS)
+        return false;
+
+    texture_file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TEXTURE_FILE_MAGIC, 4);
+    header.version = TEXTURE_FILE_VERSION;
+    header.width = chain.levels[0].width;
+    header.height = chain.levels[0].height;
+    header.level_count = (uint32_t)chain.levels.size();
+    header.format = TEXTURE_FORMAT_RGBA8;
+    header.source_size = source.size;
+    header.source_mtime = source.mtime;
+    header.source_hash = source.hash;
+
+    // lay out levels
+    uint64_t offset = align_offset(sizeof(header));
+    for (size_t l = 0; l < chain.levels.size(); l++)
+    {
+        header.levels[l] = chain.levels[l];
+        header.levels[l].offset = offset;
+        offset = align_offset(offset + level_size(chain.levels[l]));
+    }
+
+    // written under a temporary name and renamed, so a crash or a concurrent reader never sees half a file
+    std::string temp_path = filepath + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        static const char zeros[TEXTURE_FILE_ALIGNMENT] = {0};
+        uint64_t position = sizeof(header);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        for (size_t l = 0; l < chain.levels.size(); l++)
+        {
+            file.write(zeros, header.levels[l].offset - position);
+            file.write(reinterpret_cast<const char *>(chain.pixels.data() + chain.levels[l].offset), level_size(chain.levels[l]));
+            position = header.levels[l].offset + level_size(chain.levels[l]);
+        }
+
+        if (!file)
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, filepath, error);
+    if (error)
+    {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    return true;
+}